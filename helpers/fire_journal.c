@@ -0,0 +1,123 @@
+#include "fire_journal.h"
+#include "stack_stats.h"
+#include <storage/storage.h>
+
+#define TAG "PT"
+
+#define FIRE_JOURNAL_QUEUE_SIZE 16
+// Records are written once this many are waiting, or once nothing new arrived for a while
+#define FIRE_JOURNAL_BATCH    8
+#define FIRE_JOURNAL_FLUSH_MS 5000
+// Never a real outcome, tells the writer thread to flush and exit
+#define FIRE_JOURNAL_STOP 0xFF
+
+struct FireJournal {
+    FuriThread* thread;
+    FuriMessageQueue* queue;
+    FireJournalRecord batch[FIRE_JOURNAL_BATCH];
+    uint8_t batch_count;
+    uint32_t dropped;
+};
+
+static void fire_journal_flush(FireJournal* journal) {
+    if(!journal->batch_count) return;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, FIRE_JOURNAL_PATH, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        bool ok = true;
+        if(storage_file_size(file) == 0) {
+            FireJournalHeader header = {
+                .version = FIRE_JOURNAL_VERSION,
+                .record_size = sizeof(FireJournalRecord),
+                .tick_frequency = furi_kernel_get_tick_frequency(),
+            };
+            memcpy(header.magic, FIRE_JOURNAL_MAGIC, sizeof(header.magic));
+            ok = storage_file_write(file, &header, sizeof(header)) == sizeof(header);
+        }
+
+        size_t size = journal->batch_count * sizeof(FireJournalRecord);
+        if(ok && storage_file_write(file, journal->batch, size) != size) {
+            ok = false;
+        }
+        if(!ok) {
+            FURI_LOG_E(TAG, "Fire journal write failed");
+        }
+    } else {
+        FURI_LOG_E(TAG, "Can't open %s", FIRE_JOURNAL_PATH);
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    journal->batch_count = 0;
+    pt_stack_sample(PtStackJournal);
+}
+
+static int32_t fire_journal_thread(void* context) {
+    FireJournal* journal = context;
+    FireJournalRecord record;
+
+    while(true) {
+        FuriStatus status = furi_message_queue_get(
+            journal->queue, &record, furi_ms_to_ticks(FIRE_JOURNAL_FLUSH_MS));
+
+        if(status != FuriStatusOk) {
+            // Quiet for a while, write out whatever is pending
+            fire_journal_flush(journal);
+            continue;
+        }
+        if(record.outcome == FIRE_JOURNAL_STOP) break;
+
+        journal->batch[journal->batch_count++] = record;
+        if(journal->batch_count == FIRE_JOURNAL_BATCH) {
+            fire_journal_flush(journal);
+        }
+    }
+
+    fire_journal_flush(journal);
+    return 0;
+}
+
+FireJournal* fire_journal_alloc(void) {
+    FireJournal* journal = malloc(sizeof(FireJournal));
+    journal->queue = furi_message_queue_alloc(FIRE_JOURNAL_QUEUE_SIZE, sizeof(FireJournalRecord));
+    journal->batch_count = 0;
+    journal->dropped = 0;
+
+    journal->thread = furi_thread_alloc_ex("PtFireJournal", 1024, fire_journal_thread, journal);
+    furi_thread_set_priority(journal->thread, FuriThreadPriorityLow);
+    furi_thread_start(journal->thread);
+
+    return journal;
+}
+
+void fire_journal_free(FireJournal* journal) {
+    furi_assert(journal);
+
+    FireJournalRecord stop = {.outcome = FIRE_JOURNAL_STOP};
+    furi_message_queue_put(journal->queue, &stop, FuriWaitForever);
+    furi_thread_join(journal->thread);
+    furi_thread_free(journal->thread);
+
+    if(journal->dropped) {
+        FURI_LOG_W(TAG, "Fire journal dropped %lu records", journal->dropped);
+    }
+
+    furi_message_queue_free(journal->queue);
+    free(journal);
+}
+
+bool fire_journal_append(FireJournal* journal, const FireJournalRecord* record) {
+    furi_assert(journal);
+    furi_assert(record->outcome != FIRE_JOURNAL_STOP);
+
+    // Called right after a fire, so never wait for room in the queue
+    if(furi_message_queue_put(journal->queue, record, 0) != FuriStatusOk) {
+        journal->dropped++;
+        return false;
+    }
+    return true;
+}
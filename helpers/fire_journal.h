@@ -0,0 +1,44 @@
+#pragma once
+
+#include <furi.h>
+
+#define FIRE_JOURNAL_PATH    APP_DATA_PATH("fires.bin")
+#define FIRE_JOURNAL_MAGIC   "PTFJ"
+#define FIRE_JOURNAL_VERSION 1
+// output_pin value for a fire sent on the external module and the internal LED
+#define FIRE_JOURNAL_PIN_BOTH 0xFE
+
+// Every countdown fire is appended to an SD file for later review. Appending only queues
+// the record, a low priority thread writes them out in batches so the fire path never
+// waits on the SD card. tools/fire_journal.py prints the file on a computer.
+typedef struct FireJournal FireJournal;
+
+typedef enum {
+    FireJournalOutcomeSent,
+    FireJournalOutcomeMissed, // Sent, but interval cycles were slept through before it
+    FireJournalOutcomeNoSignal,
+} FireJournalOutcome;
+
+// Written once at the start of an empty file
+typedef struct {
+    char magic[4];
+    uint8_t version;
+    uint8_t record_size;
+    uint16_t tick_frequency; // Ticks per second, to turn the tick fields into time
+} FURI_PACKED FireJournalHeader;
+
+typedef struct {
+    uint32_t start_time; // RTC timestamp the countdown was started at
+    uint32_t deadline_tick;
+    uint32_t fire_tick; // When the first signal went out, or the timer fired without one
+    uint32_t signal_id; // Fingerprint of the first signal in the macro
+    uint16_t cycle;
+    uint8_t slot;
+    uint8_t output_pin; // FuriHalInfraredTxPin
+    uint8_t sent;
+    uint8_t outcome; // FireJournalOutcome
+} FURI_PACKED FireJournalRecord;
+
+FireJournal* fire_journal_alloc(void);
+void fire_journal_free(FireJournal* journal);
+bool fire_journal_append(FireJournal* journal, const FireJournalRecord* record);
@@ -0,0 +1,201 @@
+#include "input_replay.h"
+
+#ifdef PT_INPUT_REPLAY
+
+#include <furi_hal_cortex.h>
+
+#define TAG "PT"
+
+// Wait this long for a view to pick up an event before moving on in fast mode
+#define INPUT_REPLAY_FAST_TIMEOUT_MS 50
+
+struct InputReplay {
+    bool replaying;
+    volatile bool stop;
+    FuriPubSub* input_events;
+    FuriPubSubSubscription* subscription;
+    FuriThread* thread;
+    FuriSemaphore* handled;
+
+    InputReplayRecord records[INPUT_REPLAY_MAX_EVENTS];
+    uint16_t count;
+    uint32_t last_tick;
+
+    uint32_t events;
+    uint32_t total_us;
+    uint32_t max_us;
+    uint32_t draws;
+};
+
+// Views don't know about the app, so the hooks report to whichever session is running
+static InputReplay* input_replay_active = NULL;
+
+static void input_replay_record_callback(const void* value, void* context) {
+    InputReplay* replay = context;
+    const InputEvent* event = value;
+
+    if(replay->count >= INPUT_REPLAY_MAX_EVENTS) return;
+
+    uint32_t now = furi_get_tick();
+    InputReplayRecord* record = &replay->records[replay->count++];
+    record->delta_ms = replay->count == 1 ?
+                           0 :
+                           (now - replay->last_tick) * 1000 / furi_kernel_get_tick_frequency();
+    record->key = event->key;
+    record->type = event->type;
+    replay->last_tick = now;
+}
+
+static bool input_replay_load(InputReplay* replay, Storage* storage) {
+    File* file = storage_file_alloc(storage);
+    bool loaded = false;
+
+    do {
+        if(!storage_file_open(file, INPUT_REPLAY_PLAY_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+
+        InputReplayHeader header;
+        if(storage_file_read(file, &header, sizeof(header)) != sizeof(header)) break;
+        if(header.magic != INPUT_REPLAY_MAGIC || header.version != INPUT_REPLAY_VERSION) {
+            FURI_LOG_W(TAG, "Replay file has the wrong format");
+            break;
+        }
+
+        replay->count = MIN(header.count, INPUT_REPLAY_MAX_EVENTS);
+        size_t size = replay->count * sizeof(InputReplayRecord);
+        if(storage_file_read(file, replay->records, size) != size) break;
+
+        loaded = true;
+    } while(false);
+
+    storage_file_close(file);
+    storage_file_free(file);
+    return loaded;
+}
+
+static void input_replay_save(InputReplay* replay) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, INPUT_REPLAY_RECORD_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        InputReplayHeader header = {
+            .magic = INPUT_REPLAY_MAGIC,
+            .version = INPUT_REPLAY_VERSION,
+            .count = replay->count,
+        };
+        storage_file_write(file, &header, sizeof(header));
+        storage_file_write(file, replay->records, replay->count * sizeof(InputReplayRecord));
+        FURI_LOG_I(TAG, "Recorded %d input events", replay->count);
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static int32_t input_replay_thread(void* context) {
+    InputReplay* replay = context;
+
+    for(uint16_t i = 0; i < replay->count && !replay->stop; i++) {
+        const InputReplayRecord* record = &replay->records[i];
+
+#ifdef PT_INPUT_REPLAY_FAST
+        UNUSED(record->delta_ms);
+#else
+        furi_delay_ms(record->delta_ms);
+#endif
+
+        InputEvent event = {
+            .sequence = i,
+            .key = record->key,
+            .type = record->type,
+        };
+        furi_pubsub_publish(replay->input_events, &event);
+
+#ifdef PT_INPUT_REPLAY_FAST
+        furi_semaphore_acquire(replay->handled, furi_ms_to_ticks(INPUT_REPLAY_FAST_TIMEOUT_MS));
+#endif
+    }
+
+    FURI_LOG_I(TAG, "Replay finished");
+    return 0;
+}
+
+InputReplay* input_replay_alloc(void) {
+    InputReplay* replay = malloc(sizeof(InputReplay));
+    memset(replay, 0, sizeof(InputReplay));
+
+    replay->input_events = furi_record_open(RECORD_INPUT_EVENTS);
+    replay->handled = furi_semaphore_alloc(1, 0);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    replay->replaying = input_replay_load(replay, storage);
+    furi_record_close(RECORD_STORAGE);
+
+    input_replay_active = replay;
+
+    if(replay->replaying) {
+        FURI_LOG_I(TAG, "Replaying %d input events", replay->count);
+        replay->thread =
+            furi_thread_alloc_ex("PtInputReplay", 1024, input_replay_thread, replay);
+        furi_thread_start(replay->thread);
+    } else {
+        replay->subscription = furi_pubsub_subscribe(
+            replay->input_events, input_replay_record_callback, replay);
+    }
+
+    return replay;
+}
+
+void input_replay_free(InputReplay* replay) {
+    furi_assert(replay);
+
+    if(replay->thread) {
+        replay->stop = true;
+        furi_thread_join(replay->thread);
+        furi_thread_free(replay->thread);
+    }
+    if(replay->subscription) {
+        furi_pubsub_unsubscribe(replay->input_events, replay->subscription);
+        input_replay_save(replay);
+    }
+    input_replay_active = NULL;
+
+    if(replay->events) {
+        FURI_LOG_I(
+            TAG,
+            "Input: %lu events, avg %luus, max %luus, %lu redraws",
+            replay->events,
+            replay->total_us / replay->events,
+            replay->max_us,
+            replay->draws);
+    }
+
+    furi_semaphore_free(replay->handled);
+    furi_record_close(RECORD_INPUT_EVENTS);
+    free(replay);
+}
+
+uint32_t input_replay_event_begin(void) {
+    return DWT->CYCCNT;
+}
+
+void input_replay_event_end(uint32_t start) {
+    InputReplay* replay = input_replay_active;
+    if(!replay) return;
+
+    uint32_t elapsed_us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+    replay->events++;
+    replay->total_us += elapsed_us;
+    if(elapsed_us > replay->max_us) replay->max_us = elapsed_us;
+
+    if(replay->replaying) {
+        furi_semaphore_release(replay->handled);
+    }
+}
+
+void input_replay_draw(void) {
+    InputReplay* replay = input_replay_active;
+    if(replay) replay->draws++;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <furi.h>
+#include <input/input.h>
+#include <storage/storage.h>
+
+// Define PT_INPUT_REPLAY to record every input event of a session to the SD card. If
+// INPUT_REPLAY_PLAY_PATH exists when the app starts it is played back instead, and the
+// time the views took to handle each event plus the number of redraws is logged on exit.
+// Define PT_INPUT_REPLAY_FAST as well to replay as fast as the views keep up rather than
+// at the recorded cadence.
+
+#define INPUT_REPLAY_RECORD_PATH APP_DATA_PATH("input.rec")
+#define INPUT_REPLAY_PLAY_PATH   APP_DATA_PATH("replay.rec")
+#define INPUT_REPLAY_MAX_EVENTS  512
+#define INPUT_REPLAY_MAGIC       0x52495450 // "PTIR"
+#define INPUT_REPLAY_VERSION     1
+
+typedef struct InputReplay InputReplay;
+
+// A recording is the header followed by count records
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+} FURI_PACKED InputReplayHeader;
+
+typedef struct {
+    uint32_t delta_ms; // Since the previous event
+    uint8_t key; // InputKey
+    uint8_t type; // InputType
+} FURI_PACKED InputReplayRecord;
+
+#ifdef PT_INPUT_REPLAY
+
+InputReplay* input_replay_alloc(void);
+void input_replay_free(InputReplay* replay);
+uint32_t input_replay_event_begin(void);
+void input_replay_event_end(uint32_t start);
+void input_replay_draw(void);
+
+#else
+
+#define input_replay_alloc()           NULL
+#define input_replay_free(replay)      UNUSED(replay)
+#define input_replay_event_begin()     0
+#define input_replay_event_end(start)  UNUSED(start)
+#define input_replay_draw()
+
+#endif
@@ -0,0 +1,122 @@
+#include "ir_analysis.h"
+#include "ir_fingerprint.h"
+#include "pt_trace.h"
+#include "stack_stats.h"
+#include "pt_memory.h"
+
+#define TAG "PT"
+
+// Number of marks tried as a frame start before giving up on a capture
+#define IR_ANALYSIS_MAX_STARTS 16
+
+struct IrAnalysis {
+    FuriThread* thread;
+    FuriMessageQueue* jobs;
+    FuriMessageQueue* results;
+    IrAnalysisDoneCallback done_callback;
+    void* context;
+};
+
+// The worker only decodes live, a second pass over the stored timings can still find a
+// protocol when the capture started mid-frame or had a glitch the live decoder gave up on
+static bool ir_analysis_decode(const IrAnalysisJob* job, InfraredMessage* message) {
+    InfraredDecoderHandler* decoder = infrared_alloc_decoder();
+    const InfraredMessage* decoded = NULL;
+    // The decoders are the biggest short-lived allocation, catch them in the session peak
+    pt_memory_sample();
+
+    // Try every mark as a potential frame start until something decodes
+    size_t last_start = MIN(job->timings_size, (size_t)IR_ANALYSIS_MAX_STARTS * 2);
+    for(size_t start = 0; start < last_start && !decoded; start += 2) {
+        infrared_reset_decoder(decoder);
+        bool level = true;
+        for(size_t i = start; i < job->timings_size && !decoded; i++) {
+            decoded = infrared_decode(decoder, level, job->timings[i]);
+            level = !level;
+        }
+        if(!decoded) {
+            decoded = infrared_check_decoder_ready(decoder);
+        }
+    }
+
+    if(decoded) {
+        *message = *decoded;
+    }
+    infrared_free_decoder(decoder);
+    return decoded != NULL;
+}
+
+static int32_t ir_analysis_thread(void* context) {
+    IrAnalysis* analysis = context;
+    IrAnalysisJob job;
+
+    while(furi_message_queue_get(analysis->jobs, &job, FuriWaitForever) == FuriStatusOk) {
+        // A job without timings is the request to exit
+        if(!job.timings) break;
+
+        IrAnalysisResult result = {
+            .slot = job.slot,
+            .step = job.step,
+            .original_fingerprint = job.fingerprint,
+            .fingerprint = job.fingerprint,
+        };
+
+        result.is_decoded = ir_analysis_decode(&job, &result.decoded_message);
+        if(result.is_decoded) {
+            result.fingerprint = ir_fingerprint_decoded(&result.decoded_message);
+        }
+        pt_trace(PtTraceAnalysisDone, job.timings_size, result.is_decoded);
+        pt_stack_sample(PtStackAnalysis);
+
+        if(furi_message_queue_put(analysis->results, &result, 0) == FuriStatusOk) {
+            if(analysis->done_callback) analysis->done_callback(analysis->context);
+        }
+    }
+
+    return 0;
+}
+
+IrAnalysis* ir_analysis_alloc(IrAnalysisDoneCallback done_callback, void* context) {
+    IrAnalysis* analysis = malloc(sizeof(IrAnalysis));
+    analysis->done_callback = done_callback;
+    analysis->context = context;
+    analysis->jobs = furi_message_queue_alloc(IR_ANALYSIS_QUEUE_SIZE, sizeof(IrAnalysisJob));
+    analysis->results =
+        furi_message_queue_alloc(IR_ANALYSIS_QUEUE_SIZE, sizeof(IrAnalysisResult));
+
+    analysis->thread = furi_thread_alloc_ex("PtIrAnalysis", 1024, ir_analysis_thread, analysis);
+    furi_thread_set_priority(analysis->thread, FuriThreadPriorityLow);
+    furi_thread_start(analysis->thread);
+
+    return analysis;
+}
+
+void ir_analysis_free(IrAnalysis* analysis) {
+    furi_assert(analysis);
+
+    IrAnalysisJob stop = {0};
+    furi_message_queue_put(analysis->jobs, &stop, FuriWaitForever);
+    furi_thread_join(analysis->thread);
+    furi_thread_free(analysis->thread);
+
+    furi_message_queue_free(analysis->jobs);
+    furi_message_queue_free(analysis->results);
+    free(analysis);
+}
+
+bool ir_analysis_submit(IrAnalysis* analysis, const IrAnalysisJob* job) {
+    furi_assert(analysis);
+    furi_assert(job->timings);
+
+    // Never block the caller, a full queue just means this capture isn't analysed
+    if(furi_message_queue_put(analysis->jobs, job, 0) != FuriStatusOk) {
+        FURI_LOG_W(TAG, "Analysis queue full");
+        return false;
+    }
+    return true;
+}
+
+bool ir_analysis_take_result(IrAnalysis* analysis, IrAnalysisResult* result) {
+    furi_assert(analysis);
+    return furi_message_queue_get(analysis->results, result, 0) == FuriStatusOk;
+}
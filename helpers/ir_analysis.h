@@ -0,0 +1,36 @@
+#pragma once
+
+#include <furi.h>
+#include <infrared.h>
+
+#define IR_ANALYSIS_QUEUE_SIZE 4
+
+// Slow signal processing runs on its own low priority thread. Jobs reference the raw
+// timings where they are stored, so the result carries the fingerprint the signal had
+// when it was submitted and must be dropped if the stored signal changed since.
+typedef struct IrAnalysis IrAnalysis;
+
+typedef struct {
+    uint8_t slot;
+    uint8_t step;
+    uint32_t fingerprint;
+    const uint32_t* timings;
+    size_t timings_size;
+} IrAnalysisJob;
+
+typedef struct {
+    uint8_t slot;
+    uint8_t step;
+    uint32_t original_fingerprint;
+    bool is_decoded;
+    InfraredMessage decoded_message;
+    uint32_t fingerprint;
+} IrAnalysisResult;
+
+// Called on the analysis thread whenever a result is ready to be taken
+typedef void (*IrAnalysisDoneCallback)(void* context);
+
+IrAnalysis* ir_analysis_alloc(IrAnalysisDoneCallback done_callback, void* context);
+void ir_analysis_free(IrAnalysis* analysis);
+bool ir_analysis_submit(IrAnalysis* analysis, const IrAnalysisJob* job);
+bool ir_analysis_take_result(IrAnalysis* analysis, IrAnalysisResult* result);
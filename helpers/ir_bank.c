@@ -0,0 +1,171 @@
+#include "ir_bank.h"
+#include <furi.h>
+
+#define TAG "PT"
+
+void ir_bank_init(IrBank* bank) {
+    furi_assert(bank);
+    memset(bank, 0, sizeof(IrBank));
+    bank->pool = malloc(IR_BANK_SLOTS * IR_BANK_SLOT_TIMINGS * sizeof(uint32_t));
+    for(uint8_t i = 0; i < IR_BANK_SLOTS; i++) {
+        ir_macro_init(&bank->slots[i].macro);
+    }
+    bank->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    ir_fingerprint_index_reset(&bank->index);
+}
+
+void ir_bank_deinit(IrBank* bank) {
+    furi_assert(bank);
+    free(bank->pool);
+    bank->pool = NULL;
+    furi_mutex_free(bank->mutex);
+    bank->mutex = NULL;
+}
+
+void ir_bank_select(IrBank* bank, uint8_t slot) {
+    furi_assert(bank);
+    furi_check(slot < IR_BANK_SLOTS);
+    bank->selected = slot;
+}
+
+IrMacro* ir_bank_selected_macro(IrBank* bank) {
+    furi_assert(bank);
+    return &bank->slots[bank->selected].macro;
+}
+
+void ir_bank_clear_slot(IrBank* bank, uint8_t slot) {
+    furi_assert(bank);
+    furi_check(slot < IR_BANK_SLOTS);
+    ir_macro_clear(&bank->slots[slot].macro);
+    bank->slots[slot].timings_used = 0;
+    ir_bank_reindex(bank);
+}
+
+// Bump allocation inside the slot's region, only clearing the slot gives it back
+uint32_t* ir_bank_alloc_timings(IrBank* bank, uint8_t slot, size_t count) {
+    furi_assert(bank);
+    furi_check(slot < IR_BANK_SLOTS);
+    IrBankSlot* bank_slot = &bank->slots[slot];
+
+    if(count > (size_t)(IR_BANK_SLOT_TIMINGS - bank_slot->timings_used)) {
+        FURI_LOG_W(TAG, "Slot %d has no room for %d timings", slot + 1, (int)count);
+        return NULL;
+    }
+
+    uint32_t* timings = &bank->pool[slot * IR_BANK_SLOT_TIMINGS + bank_slot->timings_used];
+    bank_slot->timings_used += count;
+    return timings;
+}
+
+// The free end of the slot, for writers that only know the size once they are done.
+// Nothing is reserved, claim what was written with ir_bank_alloc_timings.
+uint32_t* ir_bank_peek_timings(IrBank* bank, uint8_t slot, size_t* capacity) {
+    furi_assert(bank);
+    furi_assert(capacity);
+    furi_check(slot < IR_BANK_SLOTS);
+    IrBankSlot* bank_slot = &bank->slots[slot];
+
+    *capacity = IR_BANK_SLOT_TIMINGS - bank_slot->timings_used;
+    return &bank->pool[slot * IR_BANK_SLOT_TIMINGS + bank_slot->timings_used];
+}
+
+// A consistent copy for a thread that sends the macro while the GUI thread may still
+// upgrade its steps. Raw timings stay where they are, only clearing the slot reuses them.
+void ir_bank_copy_macro(IrBank* bank, uint8_t slot, IrMacro* macro) {
+    furi_assert(bank);
+    furi_assert(macro);
+    furi_check(slot < IR_BANK_SLOTS);
+    furi_check(furi_mutex_acquire(bank->mutex, FuriWaitForever) == FuriStatusOk);
+    *macro = bank->slots[slot].macro;
+    furi_mutex_release(bank->mutex);
+}
+
+// Swaps a raw step for the message it decoded to, unless the step was relearned since.
+// The decoded message shares storage with the raw timings pointer, so a copy taken
+// halfway through would send garbage.
+bool ir_bank_upgrade_step(
+    IrBank* bank,
+    uint8_t slot,
+    uint8_t step,
+    uint32_t original_fingerprint,
+    const InfraredMessage* message,
+    uint32_t fingerprint) {
+    furi_assert(bank);
+    furi_assert(message);
+    furi_check(slot < IR_BANK_SLOTS);
+    IrMacro* macro = &bank->slots[slot].macro;
+    if(step >= macro->count) return false;
+
+    IrSignalStorage* signal = &macro->steps[step].signal;
+    if(signal->fingerprint != original_fingerprint || signal->kind != IrSignalKindRaw) {
+        return false;
+    }
+
+    furi_check(furi_mutex_acquire(bank->mutex, FuriWaitForever) == FuriStatusOk);
+    ir_signal_set_decoded(signal, message);
+    signal->fingerprint = fingerprint;
+    furi_mutex_release(bank->mutex);
+    return true;
+}
+
+// Adds a step once its signal is filled in
+void ir_bank_index_step(IrBank* bank, uint8_t slot, uint8_t step) {
+    furi_assert(bank);
+    furi_check(slot < IR_BANK_SLOTS);
+    const IrMacro* macro = &bank->slots[slot].macro;
+    furi_check(step < macro->count);
+
+    furi_check(furi_mutex_acquire(bank->mutex, FuriWaitForever) == FuriStatusOk);
+    ir_fingerprint_index_add(
+        &bank->index, macro->steps[step].signal.fingerprint, slot * IR_MACRO_MAX_STEPS + step);
+    furi_mutex_release(bank->mutex);
+}
+
+// Clearing a slot can't remove single entries from the open addressing index, so it is
+// rebuilt, there are only a few dozen signals at most. Lookups wait for the rebuild
+// instead of seeing a half empty index.
+void ir_bank_reindex(IrBank* bank) {
+    furi_assert(bank);
+    furi_check(furi_mutex_acquire(bank->mutex, FuriWaitForever) == FuriStatusOk);
+    ir_fingerprint_index_reset(&bank->index);
+    for(uint8_t slot = 0; slot < IR_BANK_SLOTS; slot++) {
+        const IrMacro* macro = &bank->slots[slot].macro;
+        for(uint8_t step = 0; step < macro->count; step++) {
+            const IrSignalStorage* signal = &macro->steps[step].signal;
+            if(!ir_signal_is_set(signal)) continue;
+            ir_fingerprint_index_add(
+                &bank->index, signal->fingerprint, slot * IR_MACRO_MAX_STEPS + step);
+        }
+    }
+    furi_mutex_release(bank->mutex);
+}
+
+bool ir_bank_find(const IrBank* bank, uint32_t fingerprint, uint8_t* slot, uint8_t* step) {
+    furi_assert(bank);
+    uint8_t value;
+    furi_check(furi_mutex_acquire(bank->mutex, FuriWaitForever) == FuriStatusOk);
+    bool found = ir_fingerprint_index_find(&bank->index, fingerprint, &value);
+    furi_mutex_release(bank->mutex);
+    if(!found) return false;
+    if(slot) *slot = value / IR_MACRO_MAX_STEPS;
+    if(step) *step = value % IR_MACRO_MAX_STEPS;
+    return true;
+}
+
+size_t ir_bank_memory_size(void) {
+    return sizeof(IrBank) + IR_BANK_SLOTS * IR_BANK_SLOT_TIMINGS * sizeof(uint32_t);
+}
+
+void ir_bank_log_usage(const IrBank* bank) {
+    furi_assert(bank);
+    FURI_LOG_I(TAG, "Signal bank: %d slots, %d bytes", IR_BANK_SLOTS, (int)ir_bank_memory_size());
+    for(uint8_t slot = 0; slot < IR_BANK_SLOTS; slot++) {
+        FURI_LOG_I(
+            TAG,
+            "Slot %d: %d steps, %d/%d timings",
+            slot + 1,
+            bank->slots[slot].macro.count,
+            bank->slots[slot].timings_used,
+            IR_BANK_SLOT_TIMINGS);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ir_macro.h"
+#include "ir_fingerprint.h"
+
+#define IR_BANK_SLOTS        4
+#define IR_BANK_SLOT_TIMINGS 512 // Raw timings shared by all steps of one slot
+
+// Each slot holds its own macro and a fixed region of one timing pool allocated up
+// front, so learning never mallocs and switching slots is just an index change
+typedef struct {
+    IrMacro macro;
+    uint16_t timings_used;
+} IrBankSlot;
+
+typedef struct {
+    IrBankSlot slots[IR_BANK_SLOTS];
+    uint32_t* pool;
+    uint8_t selected;
+    // The IR worker looks captures up and the fire thread copies macros out while the
+    // GUI thread edits the slots
+    FuriMutex* mutex;
+    IrFingerprintIndex index;
+} IrBank;
+
+void ir_bank_init(IrBank* bank);
+void ir_bank_deinit(IrBank* bank);
+
+void ir_bank_select(IrBank* bank, uint8_t slot);
+IrMacro* ir_bank_selected_macro(IrBank* bank);
+
+void ir_bank_clear_slot(IrBank* bank, uint8_t slot);
+uint32_t* ir_bank_alloc_timings(IrBank* bank, uint8_t slot, size_t count);
+uint32_t* ir_bank_peek_timings(IrBank* bank, uint8_t slot, size_t* capacity);
+void ir_bank_copy_macro(IrBank* bank, uint8_t slot, IrMacro* macro);
+bool ir_bank_upgrade_step(
+    IrBank* bank,
+    uint8_t slot,
+    uint8_t step,
+    uint32_t original_fingerprint,
+    const InfraredMessage* message,
+    uint32_t fingerprint);
+void ir_bank_index_step(IrBank* bank, uint8_t slot, uint8_t step);
+void ir_bank_reindex(IrBank* bank);
+bool ir_bank_find(const IrBank* bank, uint32_t fingerprint, uint8_t* slot, uint8_t* step);
+
+size_t ir_bank_memory_size(void);
+void ir_bank_log_usage(const IrBank* bank);
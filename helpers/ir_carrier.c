@@ -0,0 +1,63 @@
+#include "ir_carrier.h"
+#include <furi.h>
+
+// Timings have to be within this many percent of a family's to count as a match
+#define IR_CARRIER_TOLERANCE 20
+// Only the start of a capture is looked at for the shortest mark
+#define IR_CARRIER_SCAN_TIMINGS 64
+
+typedef struct {
+    uint32_t header_mark_us; // 0 for families whose first mark is a plain bit
+    uint32_t unit_us; // Shortest mark
+    uint32_t frequency;
+} IrCarrierFamily;
+
+// Ordered so that the more specific headers are tried first
+static const IrCarrierFamily ir_carrier_families[] = {
+    {.header_mark_us = 9000, .unit_us = 560, .frequency = 38000}, // NEC
+    {.header_mark_us = 4500, .unit_us = 550, .frequency = 38000}, // Samsung
+    {.header_mark_us = 3456, .unit_us = 432, .frequency = 36700}, // Kaseikyo
+    {.header_mark_us = 2666, .unit_us = 444, .frequency = 36000}, // RC6
+    {.header_mark_us = 2400, .unit_us = 600, .frequency = 40000}, // SIRC
+    {.header_mark_us = 0, .unit_us = 889, .frequency = 36000}, // RC5
+};
+
+static bool ir_carrier_near(uint32_t value, uint32_t expected) {
+    uint32_t delta = value > expected ? value - expected : expected - value;
+    return delta * 100 <= expected * IR_CARRIER_TOLERANCE;
+}
+
+IrCarrier ir_carrier_estimate(const uint32_t* timings, size_t timings_size) {
+    IrCarrier carrier = {
+        .frequency = INFRARED_COMMON_CARRIER_FREQUENCY,
+        .duty_cycle = INFRARED_COMMON_DUTY_CYCLE,
+    };
+    if(!timings || timings_size < 2) return carrier;
+
+    // Captures start on a mark, so marks are the even timings
+    uint32_t unit = UINT32_MAX;
+    size_t count = MIN(timings_size, (size_t)IR_CARRIER_SCAN_TIMINGS);
+    for(size_t i = 0; i < count; i += 2) {
+        if(timings[i] && timings[i] < unit) unit = timings[i];
+    }
+
+    for(size_t i = 0; i < COUNT_OF(ir_carrier_families); i++) {
+        const IrCarrierFamily* family = &ir_carrier_families[i];
+        if(!ir_carrier_near(unit, family->unit_us)) continue;
+
+        bool header_matches;
+        if(family->header_mark_us) {
+            header_matches = ir_carrier_near(timings[0], family->header_mark_us);
+        } else {
+            // Without a header the first mark is one or two units long
+            header_matches = timings[0] <= family->unit_us * 2 + family->unit_us / 2;
+        }
+
+        if(header_matches) {
+            carrier.frequency = family->frequency;
+            break;
+        }
+    }
+
+    return carrier;
+}
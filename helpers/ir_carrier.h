@@ -0,0 +1,13 @@
+#pragma once
+
+#include <infrared.h>
+
+// The receiver demodulates the carrier away, so a raw capture only has its mark and
+// space lengths. Remote families pair a distinctive header and bit unit with a fixed
+// carrier though, so the carrier is inferred from those instead of assuming 38 kHz.
+typedef struct {
+    uint32_t frequency;
+    float duty_cycle;
+} IrCarrier;
+
+IrCarrier ir_carrier_estimate(const uint32_t* timings, size_t timings_size);
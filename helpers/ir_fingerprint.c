@@ -0,0 +1,128 @@
+#include "ir_fingerprint.h"
+#include <furi.h>
+
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME  16777619UL
+
+// Raw timings are hashed as rounded multiples of the protocol's base unit, so the few
+// percent of jitter between two captures of the same button hash the same. Past a few
+// units rounding gets too fine for that, so longer headers and gaps go by octave
+#define IR_FINGERPRINT_ROUNDED_UNITS 6
+#define IR_FINGERPRINT_MAX_OCTAVE    5
+
+static uint32_t ir_fingerprint_mix(uint32_t hash, uint32_t value) {
+    for(uint8_t i = 0; i < 4; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t ir_fingerprint_finish(uint32_t hash) {
+    return hash == IR_FINGERPRINT_NONE ? 1 : hash;
+}
+
+static uint32_t ir_fingerprint_quantize(uint32_t timing, uint32_t unit) {
+    uint32_t units = (timing + unit / 2) / unit;
+    if(units <= IR_FINGERPRINT_ROUNDED_UNITS) return units;
+
+    // Octaves are centred on powers of two, so a 16 unit NEC header has about 30% of slack.
+    // That is floor(log2(2 * ratio^2) / 2), worked out on the square to stay in integers
+    uint64_t capped = MIN((uint64_t)timing, (uint64_t)unit << (IR_FINGERPRINT_MAX_OCTAVE + 1));
+    uint64_t ratio_squared = capped * capped * 2 / ((uint64_t)unit * unit);
+    uint32_t octave = 0;
+    while(ratio_squared >>= 2) octave++;
+    return IR_FINGERPRINT_ROUNDED_UNITS + MIN(octave, (uint32_t)IR_FINGERPRINT_MAX_OCTAVE);
+}
+
+uint32_t ir_fingerprint_decoded(const InfraredMessage* message) {
+    furi_assert(message);
+    uint32_t hash = FNV_OFFSET;
+    hash = ir_fingerprint_mix(hash, message->protocol);
+    hash = ir_fingerprint_mix(hash, message->address);
+    hash = ir_fingerprint_mix(hash, message->command);
+    return ir_fingerprint_finish(hash);
+}
+
+uint32_t ir_fingerprint_raw(const uint32_t* timings, size_t timings_size) {
+    furi_assert(timings);
+    // The trailing gap depends on when the receiver timed out, not on the button
+    size_t count = timings_size > 1 ? timings_size - 1 : timings_size;
+    count = MIN(count, (size_t)IR_FINGERPRINT_RAW_TIMINGS);
+
+    uint32_t shortest = UINT32_MAX;
+    for(size_t i = 0; i < count; i++) {
+        if(timings[i] && timings[i] < shortest) shortest = timings[i];
+    }
+
+    // The unit is the mean of the pulses close to the shortest one rather than the shortest
+    // alone, a single clipped pulse would otherwise rescale every other timing
+    uint32_t unit = 1;
+    if(shortest != UINT32_MAX) {
+        uint32_t limit = shortest + shortest / 2;
+        uint64_t sum = 0;
+        uint32_t pulses = 0;
+        for(size_t i = 0; i < count; i++) {
+            if(timings[i] && timings[i] <= limit) {
+                sum += timings[i];
+                pulses++;
+            }
+        }
+        unit = (uint32_t)(sum / pulses);
+    }
+
+    uint32_t hash = ir_fingerprint_mix(FNV_OFFSET, count);
+    for(size_t i = 0; i < count; i++) {
+        hash = ir_fingerprint_mix(hash, ir_fingerprint_quantize(timings[i], unit));
+    }
+    return ir_fingerprint_finish(hash);
+}
+
+uint32_t ir_fingerprint_signal(const IrSignalStorage* signal) {
+    furi_assert(signal);
+    if(signal->kind == IrSignalKindDecoded) return ir_fingerprint_decoded(&signal->decoded);
+    if(signal->kind == IrSignalKindRaw) {
+        return ir_fingerprint_raw(signal->raw.timings, signal->raw.timings_size);
+    }
+    return IR_FINGERPRINT_NONE;
+}
+
+void ir_fingerprint_index_reset(IrFingerprintIndex* index) {
+    furi_assert(index);
+    memset(index, 0, sizeof(IrFingerprintIndex));
+}
+
+// Open addressing with linear probing, the first signal added for a fingerprint wins
+bool ir_fingerprint_index_add(IrFingerprintIndex* index, uint32_t fingerprint, uint8_t value) {
+    furi_assert(index);
+    if(fingerprint == IR_FINGERPRINT_NONE) return false;
+
+    for(uint8_t probe = 0; probe < IR_FINGERPRINT_INDEX_SIZE; probe++) {
+        uint8_t slot = (fingerprint + probe) & (IR_FINGERPRINT_INDEX_SIZE - 1);
+        if(index->keys[slot] == fingerprint) return false;
+        if(index->keys[slot] == IR_FINGERPRINT_NONE) {
+            index->keys[slot] = fingerprint;
+            index->values[slot] = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ir_fingerprint_index_find(
+    const IrFingerprintIndex* index,
+    uint32_t fingerprint,
+    uint8_t* value) {
+    furi_assert(index);
+    if(fingerprint == IR_FINGERPRINT_NONE) return false;
+
+    for(uint8_t probe = 0; probe < IR_FINGERPRINT_INDEX_SIZE; probe++) {
+        uint8_t slot = (fingerprint + probe) & (IR_FINGERPRINT_INDEX_SIZE - 1);
+        if(index->keys[slot] == IR_FINGERPRINT_NONE) return false;
+        if(index->keys[slot] == fingerprint) {
+            if(value) *value = index->values[slot];
+            return true;
+        }
+    }
+    return false;
+}
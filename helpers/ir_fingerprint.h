@@ -0,0 +1,25 @@
+#pragma once
+
+#include <infrared.h>
+#include "ir_signal.h"
+
+// Fingerprints are never 0 so the index can use it to mark empty slots
+#define IR_FINGERPRINT_NONE        0
+#define IR_FINGERPRINT_INDEX_SIZE  64 // Must be a power of two, at least twice the signal count
+#define IR_FINGERPRINT_RAW_TIMINGS 64 // Only the start of a raw capture is hashed
+
+typedef struct {
+    uint32_t keys[IR_FINGERPRINT_INDEX_SIZE];
+    uint8_t values[IR_FINGERPRINT_INDEX_SIZE];
+} IrFingerprintIndex;
+
+uint32_t ir_fingerprint_decoded(const InfraredMessage* message);
+uint32_t ir_fingerprint_raw(const uint32_t* timings, size_t timings_size);
+uint32_t ir_fingerprint_signal(const IrSignalStorage* signal);
+
+void ir_fingerprint_index_reset(IrFingerprintIndex* index);
+bool ir_fingerprint_index_add(IrFingerprintIndex* index, uint32_t fingerprint, uint8_t value);
+bool ir_fingerprint_index_find(
+    const IrFingerprintIndex* index,
+    uint32_t fingerprint,
+    uint8_t* value);
@@ -0,0 +1,262 @@
+#include "ir_import.h"
+#include <furi.h>
+#include <stdlib.h>
+
+#define TAG "PT"
+
+#define IR_IMPORT_BUFFER    64
+#define IR_IMPORT_TOKEN_LEN 16
+
+typedef struct {
+    File* file;
+    char buffer[IR_IMPORT_BUFFER];
+    uint16_t length;
+    uint16_t position;
+} IrImportReader;
+
+// Returns the next character or -1 at the end of the file
+static int ir_import_getc(IrImportReader* reader) {
+    if(reader->position == reader->length) {
+        reader->length = storage_file_read(reader->file, reader->buffer, IR_IMPORT_BUFFER);
+        reader->position = 0;
+        if(!reader->length) return -1;
+    }
+    return (unsigned char)reader->buffer[reader->position++];
+}
+
+static int ir_import_peek(IrImportReader* reader) {
+    int c = ir_import_getc(reader);
+    if(c >= 0) reader->position--;
+    return c;
+}
+
+static void ir_import_skip_line(IrImportReader* reader) {
+    int c;
+    do {
+        c = ir_import_getc(reader);
+    } while(c >= 0 && c != '\n');
+}
+
+// Reads the key of the next "key: value" line, skipping blank and comment lines.
+// Returns false at the end of the file.
+static bool ir_import_read_key(IrImportReader* reader, char* key, size_t size) {
+    while(true) {
+        int c = ir_import_getc(reader);
+        if(c < 0) return false;
+        if(c == '\n' || c == '\r' || c == ' ') continue;
+        if(c == '#') {
+            ir_import_skip_line(reader);
+            continue;
+        }
+
+        size_t length = 0;
+        while(c >= 0 && c != ':' && c != '\n') {
+            if(length < size - 1) key[length++] = c;
+            c = ir_import_getc(reader);
+        }
+        key[length] = '\0';
+        if(c != ':') continue; // Not a key, the rest of the line is already consumed
+        return true;
+    }
+}
+
+// Reads the next space separated value on the current line. Returns false once the
+// line has been used up, the newline is consumed then.
+static bool ir_import_read_token(IrImportReader* reader, char* token, size_t size) {
+    int c = ir_import_peek(reader);
+    while(c == ' ' || c == '\r') {
+        ir_import_getc(reader);
+        c = ir_import_peek(reader);
+    }
+    if(c < 0) return false;
+    if(c == '\n') {
+        ir_import_getc(reader);
+        return false;
+    }
+
+    size_t length = 0;
+    while(c >= 0 && c != ' ' && c != '\r' && c != '\n') {
+        ir_import_getc(reader);
+        if(length < size - 1) token[length++] = c;
+        c = ir_import_peek(reader);
+    }
+    token[length] = '\0';
+    return true;
+}
+
+// The rest of the line with the surrounding spaces dropped, names can contain spaces
+static void ir_import_read_value(IrImportReader* reader, char* value, size_t size) {
+    size_t length = 0;
+    int c = ir_import_getc(reader);
+    while(c == ' ') {
+        c = ir_import_getc(reader);
+    }
+    while(c >= 0 && c != '\n') {
+        if(c != '\r' && length < size - 1) value[length++] = c;
+        c = ir_import_getc(reader);
+    }
+    while(length && value[length - 1] == ' ') {
+        length--;
+    }
+    value[length] = '\0';
+}
+
+// Addresses and commands are stored as little endian hex bytes, "04 00 00 00"
+static uint32_t ir_import_read_bytes(IrImportReader* reader) {
+    char token[IR_IMPORT_TOKEN_LEN];
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    while(ir_import_read_token(reader, token, sizeof(token))) {
+        if(shift < 32) value |= strtoul(token, NULL, 16) << shift;
+        shift += 8;
+    }
+    return value;
+}
+
+static bool ir_import_open(IrImportReader* reader, Storage* storage, const char* path) {
+    reader->file = storage_file_alloc(storage);
+    reader->length = 0;
+    reader->position = 0;
+    if(!storage_file_open(reader->file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Can't open %s", path);
+        return false;
+    }
+    return true;
+}
+
+static void ir_import_close(IrImportReader* reader) {
+    storage_file_close(reader->file);
+    storage_file_free(reader->file);
+}
+
+bool ir_import_list(
+    Storage* storage,
+    const char* path,
+    IrImportNameCallback callback,
+    void* context) {
+    furi_assert(path);
+    furi_assert(callback);
+
+    IrImportReader reader;
+    bool ok = ir_import_open(&reader, storage, path);
+    if(ok) {
+        char key[IR_IMPORT_TOKEN_LEN];
+        char name[IR_IMPORT_NAME_LEN];
+        while(ir_import_read_key(&reader, key, sizeof(key))) {
+            if(strcmp(key, "name") == 0) {
+                ir_import_read_value(&reader, name, sizeof(name));
+                callback(context, name);
+            } else {
+                ir_import_skip_line(&reader);
+            }
+        }
+    }
+    ir_import_close(&reader);
+    return ok;
+}
+
+// Everything but the signal's own lines is skipped without being tokenized
+static IrImportStatus ir_import_parse(
+    IrImportReader* reader,
+    const char* name,
+    uint32_t* timings,
+    size_t capacity,
+    IrSignalStorage* signal) {
+    char key[IR_IMPORT_TOKEN_LEN];
+    char value[IR_IMPORT_NAME_LEN];
+    bool found = false;
+    bool is_raw = false;
+    InfraredMessage message = {.protocol = InfraredProtocolUnknown};
+    uint32_t frequency = INFRARED_COMMON_CARRIER_FREQUENCY;
+    float duty_cycle = INFRARED_COMMON_DUTY_CYCLE;
+    size_t count = 0;
+
+    while(ir_import_read_key(reader, key, sizeof(key))) {
+        if(strcmp(key, "name") == 0) {
+            // The next signal starts, nothing after the one we wanted matters
+            if(found) break;
+            ir_import_read_value(reader, value, sizeof(value));
+            found = strcmp(value, name) == 0;
+        } else if(!found) {
+            ir_import_skip_line(reader);
+        } else if(strcmp(key, "type") == 0) {
+            ir_import_read_value(reader, value, sizeof(value));
+            is_raw = strcmp(value, "raw") == 0;
+        } else if(strcmp(key, "protocol") == 0) {
+            ir_import_read_value(reader, value, sizeof(value));
+            message.protocol = infrared_get_protocol_by_name(value);
+        } else if(strcmp(key, "address") == 0) {
+            message.address = ir_import_read_bytes(reader);
+        } else if(strcmp(key, "command") == 0) {
+            message.command = ir_import_read_bytes(reader);
+        } else if(strcmp(key, "frequency") == 0) {
+            ir_import_read_value(reader, value, sizeof(value));
+            frequency = strtoul(value, NULL, 10);
+        } else if(strcmp(key, "duty_cycle") == 0) {
+            ir_import_read_value(reader, value, sizeof(value));
+            duty_cycle = strtof(value, NULL);
+        } else if(strcmp(key, "data") == 0) {
+            char token[IR_IMPORT_TOKEN_LEN];
+            while(ir_import_read_token(reader, token, sizeof(token))) {
+                if(count == capacity) return IrImportErrorTooLong;
+                uint32_t timing = strtoul(token, NULL, 10);
+                if(timings) timings[count] = timing;
+                count++;
+            }
+        } else {
+            ir_import_skip_line(reader);
+        }
+    }
+
+    if(!found) return IrImportErrorNotFound;
+
+    if(is_raw) {
+        // The transmitter only rejects a bad carrier by crashing once the signal is sent,
+        // so hold the file to the same limits the Infrared app does
+        if(!count || count > UINT16_MAX || frequency < INFRARED_MIN_FREQUENCY ||
+           frequency > INFRARED_MAX_FREQUENCY || !(duty_cycle > 0.0f && duty_cycle <= 1.0f)) {
+            return IrImportErrorFormat;
+        }
+        ir_signal_set_raw(signal, timings, count, frequency, duty_cycle);
+    } else {
+        if(!infrared_is_protocol_valid(message.protocol)) return IrImportErrorFormat;
+        ir_signal_set_decoded(signal, &message);
+    }
+    return IrImportOk;
+}
+
+IrImportStatus ir_import_signal(
+    Storage* storage,
+    const char* path,
+    const char* name,
+    uint32_t* timings,
+    size_t capacity,
+    IrSignalStorage* signal) {
+    furi_assert(path);
+    furi_assert(name);
+    furi_assert(signal);
+
+    IrImportReader reader;
+    IrImportStatus status = IrImportErrorOpen;
+    if(ir_import_open(&reader, storage, path)) {
+        status = ir_import_parse(&reader, name, timings, capacity, signal);
+    }
+    ir_import_close(&reader);
+    return status;
+}
+
+const char* ir_import_status_text(IrImportStatus status) {
+    switch(status) {
+    case IrImportOk:
+        return "Imported";
+    case IrImportErrorOpen:
+        return "Can't open file";
+    case IrImportErrorNotFound:
+        return "Button not found";
+    case IrImportErrorFormat:
+        return "Unsupported signal";
+    case IrImportErrorTooLong:
+        return "Signal too long for slot";
+    }
+    return "Import failed";
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <storage/storage.h>
+#include "ir_signal.h"
+
+#define IR_IMPORT_EXTENSION ".ir"
+#define IR_IMPORT_FOLDER    EXT_PATH("infrared")
+#define IR_IMPORT_NAME_LEN  32
+
+// Reads remotes saved by the stock Infrared app. Files are tokenized front to back
+// through a small fixed buffer, never loaded whole, so large universal remote files
+// cost no more memory than small ones.
+typedef enum {
+    IrImportOk,
+    IrImportErrorOpen,
+    IrImportErrorNotFound,
+    IrImportErrorFormat,
+    IrImportErrorTooLong, // Raw data didn't fit in the timings buffer
+} IrImportStatus;
+
+// Called for every signal in file order, names repeat in universal remote files
+typedef void (*IrImportNameCallback)(void* context, const char* name);
+
+bool ir_import_list(
+    Storage* storage,
+    const char* path,
+    IrImportNameCallback callback,
+    void* context);
+
+// Parses only the first signal called name. Raw data is converted straight into
+// timings, which must hold up to capacity entries, and signal->raw.timings points there.
+// With timings NULL the signal is only checked, raw data is counted against capacity.
+IrImportStatus ir_import_signal(
+    Storage* storage,
+    const char* path,
+    const char* name,
+    uint32_t* timings,
+    size_t capacity,
+    IrSignalStorage* signal);
+
+const char* ir_import_status_text(IrImportStatus status);
@@ -0,0 +1,57 @@
+#include "ir_macro.h"
+#include <furi.h>
+
+#define TAG "PT"
+
+void ir_macro_init(IrMacro* macro) {
+    furi_assert(macro);
+    memset(macro, 0, sizeof(IrMacro));
+}
+
+// Raw timings belong to the signal bank, so there is nothing to free here
+void ir_macro_clear(IrMacro* macro) {
+    furi_assert(macro);
+    ir_macro_init(macro);
+}
+
+IrSignalStorage* ir_macro_append(IrMacro* macro, uint32_t delay_ms) {
+    furi_assert(macro);
+    if(macro->count >= IR_MACRO_MAX_STEPS) {
+        FURI_LOG_W(TAG, "Macro is full (%d steps)", IR_MACRO_MAX_STEPS);
+        return NULL;
+    }
+
+    IrMacroStep* step = &macro->steps[macro->count++];
+    memset(step, 0, sizeof(IrMacroStep));
+    // The first step always goes out on the deadline itself
+    step->delay_ms = (macro->count == 1) ? 0 : delay_ms;
+
+    ir_macro_compile(macro);
+    return &step->signal;
+}
+
+void ir_macro_remove_last(IrMacro* macro) {
+    furi_assert(macro);
+    if(!macro->count) return;
+    macro->count--;
+    ir_macro_compile(macro);
+}
+
+// Flatten the per-step delays into absolute offsets from the deadline so the
+// executor never accumulates the time spent sending earlier steps
+void ir_macro_compile(IrMacro* macro) {
+    furi_assert(macro);
+    uint32_t offset = 0;
+    for(uint8_t i = 0; i < macro->count; i++) {
+        offset += macro->steps[i].delay_ms;
+        macro->steps[i].offset_ms = offset;
+    }
+}
+
+bool ir_macro_has_signal(const IrMacro* macro) {
+    furi_assert(macro);
+    for(uint8_t i = 0; i < macro->count; i++) {
+        if(ir_signal_is_set(&macro->steps[i].signal)) return true;
+    }
+    return false;
+}
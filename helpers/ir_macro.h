@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ir_signal.h"
+#include <furi.h>
+#include <furi_hal_infrared.h>
+
+#define IR_MACRO_MAX_STEPS      8
+#define IR_MACRO_DEFAULT_GAP_MS 500
+
+// One signal in a macro and how long to wait after the previous step before sending it
+typedef struct {
+    IrSignalStorage signal;
+    uint32_t delay_ms;
+    uint32_t offset_ms; // Filled in by ir_macro_compile, relative to the deadline
+} IrMacroStep;
+
+PT_SIZE_BUDGET(IrMacroStep, 32);
+
+typedef struct {
+    IrMacroStep steps[IR_MACRO_MAX_STEPS];
+    uint8_t count;
+} IrMacro;
+
+// What actually happened while executing a macro
+typedef struct {
+    uint32_t first_tick; // When the first step went out
+    FuriHalInfraredTxPin output_pin;
+    uint8_t sent;
+    bool dual_output; // Each step went out on the external module and the internal LED
+    uint16_t dead_time_us; // Worst gap from one emission of a step ending to the next starting
+    bool cancelled; // Stopped before every step went out
+} IrMacroFireReport;
+
+void ir_macro_init(IrMacro* macro);
+void ir_macro_clear(IrMacro* macro);
+IrSignalStorage* ir_macro_append(IrMacro* macro, uint32_t delay_ms);
+void ir_macro_remove_last(IrMacro* macro);
+void ir_macro_compile(IrMacro* macro);
+bool ir_macro_has_signal(const IrMacro* macro);
+// Releasing cancel while this runs ends it before the next step, NULL runs it to the end
+uint8_t ir_macro_execute(
+    const IrMacro* macro,
+    uint32_t deadline_tick,
+    bool dual_output,
+    FuriSemaphore* cancel,
+    IrMacroFireReport* report);
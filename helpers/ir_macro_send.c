@@ -0,0 +1,178 @@
+#include "ir_macro.h"
+#include "pt_trace.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <furi_hal_power.h>
+#include <furi_hal_cortex.h>
+#include <infrared_transmit.h>
+
+#define TAG "PT"
+
+static void ir_macro_send_signal(const IrSignalStorage* signal) {
+    // Figure out if it's raw or decoded and send it accordingly
+    if(signal->kind == IrSignalKindDecoded) {
+        infrared_send(&signal->decoded, 1);
+    } else if(signal->kind == IrSignalKindRaw) {
+        // Send on the carrier estimated when it was learned, not the 38 kHz default
+        infrared_send_raw_ext(
+            signal->raw.timings,
+            signal->raw.timings_size,
+            true,
+            signal->raw.frequency,
+            ir_signal_duty_cycle(signal));
+    }
+}
+
+// The second emission of a dual output step. It feeds the transmitter itself instead of
+// going through infrared_send, so the first timing it hands out can be timestamped and a
+// raw signal doesn't start with the silence infrared_send_raw_ext puts in front.
+typedef struct {
+    const IrSignalStorage* signal;
+    InfraredEncoderHandler* encoder; // Decoded signals only
+    uint32_t frequency;
+    float duty_cycle;
+    size_t index; // Raw timings handed out so far
+    size_t repeats; // Decoded frames still to send
+    bool started;
+    uint32_t start_cycles; // DWT->CYCCNT when the transmitter asked for the first timing
+} IrMacroTx;
+
+// Runs from the transmitter, first while it fills its buffers and then in its DMA interrupt
+static FuriHalInfraredTxGetDataState
+    ir_macro_tx_data_callback(void* context, uint32_t* duration, bool* level) {
+    IrMacroTx* tx = context;
+    if(!tx->started) {
+        tx->start_cycles = DWT->CYCCNT;
+        tx->started = true;
+    }
+
+    if(tx->encoder) {
+        InfraredStatus status = infrared_encode(tx->encoder, duration, level);
+        if(status == InfraredStatusOk) return FuriHalInfraredTxGetDataStateOk;
+        if(status == InfraredStatusDone && --tx->repeats) return FuriHalInfraredTxGetDataStateDone;
+        if(status != InfraredStatusDone) {
+            *duration = 0;
+            *level = false;
+        }
+        return FuriHalInfraredTxGetDataStateLastDone;
+    }
+
+    const IrSignalStorage* signal = tx->signal;
+    *duration = signal->raw.timings[tx->index];
+    *level = !(tx->index % 2); // Raw timings start with a mark
+    tx->index++;
+    return tx->index < signal->raw.timings_size ? FuriHalInfraredTxGetDataStateOk :
+                                                  FuriHalInfraredTxGetDataStateLastDone;
+}
+
+// Done before the first emission, so allocating the encoder isn't part of the gap
+static void ir_macro_tx_prepare(IrMacroTx* tx, const IrSignalStorage* signal) {
+    memset(tx, 0, sizeof(IrMacroTx));
+    tx->signal = signal;
+    if(signal->kind == IrSignalKindDecoded) {
+        InfraredProtocol protocol = signal->decoded.protocol;
+        tx->encoder = infrared_alloc_encoder();
+        infrared_reset_encoder(tx->encoder, &signal->decoded);
+        tx->repeats = MAX(infrared_get_protocol_min_repeat_count(protocol), 1U);
+        tx->frequency = infrared_get_protocol_frequency(protocol);
+        tx->duty_cycle = infrared_get_protocol_duty_cycle(protocol);
+    } else {
+        tx->frequency = signal->raw.frequency;
+        tx->duty_cycle = ir_signal_duty_cycle(signal);
+    }
+}
+
+// Sends the prepared step on the internal LED and returns the microseconds from
+// first_done, when the external module's emission ended, to the second one starting
+static uint32_t ir_macro_send_second_output(IrMacroTx* tx, uint32_t first_done) {
+    furi_hal_infrared_set_tx_output(FuriHalInfraredTxPinInternal);
+    furi_hal_infrared_async_tx_set_data_isr_callback(ir_macro_tx_data_callback, tx);
+    furi_hal_infrared_async_tx_start(tx->frequency, tx->duty_cycle);
+    furi_hal_infrared_async_tx_wait_termination();
+    furi_hal_infrared_set_tx_output(FuriHalInfraredTxPinExtPA7);
+
+    if(tx->encoder) infrared_free_encoder(tx->encoder);
+    return (tx->start_cycles - first_done) / furi_hal_cortex_instructions_per_microsecond();
+}
+
+uint8_t ir_macro_execute(
+    const IrMacro* macro,
+    uint32_t deadline_tick,
+    bool dual_output,
+    FuriSemaphore* cancel,
+    IrMacroFireReport* report) {
+    furi_assert(macro);
+    if(report) {
+        memset(report, 0, sizeof(IrMacroFireReport));
+    }
+    if(!ir_macro_has_signal(macro)) {
+        FURI_LOG_W(TAG, "No IR signal to transmit");
+        return 0;
+    }
+    uint32_t fire_start = furi_get_tick();
+    pt_trace(PtTraceFireStart, macro->count, deadline_tick);
+
+    // Detect external module and configure it once for the whole sequence
+    FuriHalInfraredTxPin output_pin = furi_hal_infrared_detect_tx_output();
+    bool using_external = (output_pin == FuriHalInfraredTxPinExtPA7);
+
+    // Stays on for both outputs, dual mode only switches the pin between them
+    if(using_external) {
+        furi_hal_power_enable_otg();
+    }
+
+    furi_hal_infrared_set_tx_output(output_pin);
+
+    // The second output is the internal LED, so dual mode needs a module plugged in
+    bool dual = dual_output && using_external;
+    uint32_t dead_time_us = 0;
+
+    uint8_t sent = 0;
+    bool cancelled = false;
+    for(uint8_t i = 0; i < macro->count; i++) {
+        const IrMacroStep* step = &macro->steps[i];
+        if(!ir_signal_is_set(&step->signal)) continue;
+
+        // Wait for this step's slot on the timeline, skipping the wait if we are already late.
+        // The wait is on the cancel semaphore, so a cancel skips every step not yet sent
+        uint32_t target = deadline_tick + furi_ms_to_ticks(step->offset_ms);
+        int32_t wait = (int32_t)(target - furi_get_tick());
+        if(cancel) {
+            cancelled = furi_semaphore_acquire(cancel, wait > 0 ? wait : 0) == FuriStatusOk;
+        } else if(wait > 0) {
+            furi_delay_tick(wait);
+        }
+        if(cancelled) break;
+        pt_trace(PtTraceFireStep, i, wait < 0 ? -wait : 0);
+
+        IrMacroTx second;
+        if(dual) ir_macro_tx_prepare(&second, &step->signal);
+
+        if(report && !sent) {
+            report->first_tick = furi_get_tick();
+        }
+        ir_macro_send_signal(&step->signal);
+        if(dual) {
+            uint32_t first_done = DWT->CYCCNT;
+            dead_time_us = MAX(dead_time_us, ir_macro_send_second_output(&second, first_done));
+        }
+        sent++;
+    }
+    furi_delay_ms(100);
+
+    // Cleanup: Reset to internal and disable power if external
+    if(using_external) {
+        furi_hal_power_disable_otg();
+    }
+    furi_hal_infrared_set_tx_output(FuriHalInfraredTxPinInternal);
+
+    pt_trace(PtTraceFireDone, sent, furi_get_tick() - fire_start);
+    if(report) {
+        report->output_pin = output_pin;
+        report->sent = sent;
+        report->dual_output = dual;
+        report->dead_time_us = MIN(dead_time_us, UINT16_MAX);
+        report->cancelled = cancelled;
+    }
+    return sent;
+}
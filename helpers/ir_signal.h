@@ -0,0 +1,60 @@
+#pragma once
+
+#include <infrared.h>
+#include "size_budget.h"
+
+typedef enum {
+    IrSignalKindNone,
+    IrSignalKindDecoded,
+    IrSignalKindRaw,
+} IrSignalKind;
+
+// A decoded message and a raw capture never live in the same signal, so they share
+// storage. Only raw captures carry a carrier, decoded protocols already define theirs.
+typedef struct {
+    uint32_t fingerprint;
+    union {
+        InfraredMessage decoded;
+        struct {
+            uint32_t* timings;
+            uint16_t timings_size;
+            uint16_t frequency; // Hz, infrared carriers stay well below 64 kHz
+            uint8_t duty_cycle; // Percent
+        } raw;
+    };
+    uint8_t kind; // IrSignalKind
+} IrSignalStorage;
+
+PT_SIZE_BUDGET(IrSignalStorage, 24);
+
+static inline bool ir_signal_is_set(const IrSignalStorage* signal) {
+    return signal->kind != IrSignalKindNone;
+}
+
+static inline bool ir_signal_is_decoded(const IrSignalStorage* signal) {
+    return signal->kind == IrSignalKindDecoded;
+}
+
+static inline void
+    ir_signal_set_decoded(IrSignalStorage* signal, const InfraredMessage* message) {
+    signal->kind = IrSignalKindDecoded;
+    signal->decoded = *message;
+}
+
+// The timings are referenced, not copied, whoever passes them in keeps owning them
+static inline void ir_signal_set_raw(
+    IrSignalStorage* signal,
+    uint32_t* timings,
+    uint16_t timings_size,
+    uint32_t frequency,
+    float duty_cycle) {
+    signal->kind = IrSignalKindRaw;
+    signal->raw.timings = timings;
+    signal->raw.timings_size = timings_size;
+    signal->raw.frequency = frequency;
+    signal->raw.duty_cycle = (uint8_t)(duty_cycle * 100.0f + 0.5f);
+}
+
+static inline float ir_signal_duty_cycle(const IrSignalStorage* signal) {
+    return signal->raw.duty_cycle / 100.0f;
+}
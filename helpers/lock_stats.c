@@ -0,0 +1,32 @@
+#include "lock_stats.h"
+
+#ifdef PT_LOCK_STATS
+
+#include <furi_hal_cortex.h>
+
+#define TAG "PT"
+
+uint32_t lock_stats_begin(void) {
+    return DWT->CYCCNT;
+}
+
+void lock_stats_end(LockStats* stats, uint32_t start) {
+    uint32_t held_us = (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+
+    stats->count++;
+    stats->total_us += held_us;
+    if(held_us > stats->max_us) stats->max_us = held_us;
+}
+
+void lock_stats_log(const LockStats* stats) {
+    if(!stats->count) return;
+    FURI_LOG_I(
+        TAG,
+        "%s lock: %lu holds, avg %luus, max %luus",
+        stats->name,
+        stats->count,
+        stats->total_us / stats->count,
+        stats->max_us);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/view.h>
+
+// Define PT_LOCK_STATS (e.g. in application.fam cdefines) to measure how long each
+// view keeps its model locked. Without it the macros below are plain with_view_model.
+
+typedef struct {
+    const char* name;
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+} LockStats;
+
+#ifdef PT_LOCK_STATS
+
+uint32_t lock_stats_begin(void);
+void lock_stats_end(LockStats* stats, uint32_t start);
+void lock_stats_log(const LockStats* stats);
+
+#define with_view_model_timed(stats, view, type, code, update) \
+    {                                                          \
+        type = view_get_model(view);                           \
+        uint32_t __lock_start = lock_stats_begin();            \
+        {code};                                                \
+        lock_stats_end(stats, __lock_start);                   \
+        view_commit_model(view, update);                       \
+    }
+
+#else
+
+#define lock_stats_begin()              0
+#define lock_stats_end(stats, start)    UNUSED(stats)
+#define lock_stats_log(stats)           UNUSED(stats)
+
+#define with_view_model_timed(stats, view, type, code, update) \
+    with_view_model(view, type, code, update)
+
+#endif
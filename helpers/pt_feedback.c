@@ -0,0 +1,66 @@
+#include "pt_feedback.h"
+#include <furi.h>
+
+struct PtFeedback {
+    NotificationApp* notifications;
+    const NotificationSequence* sequences[PtFeedbackEventNum];
+};
+
+// The same 100 ms buzz the callbacks used to produce by sleeping, plus a matching blink
+static const NotificationSequence pt_feedback_learned = {
+    &message_vibro_on,
+    &message_green_255,
+    &message_delay_100,
+    &message_vibro_off,
+    &message_green_0,
+    NULL,
+};
+
+static const NotificationSequence pt_feedback_fired = {
+    &message_vibro_on,
+    &message_blue_255,
+    &message_delay_100,
+    &message_vibro_off,
+    &message_blue_0,
+    NULL,
+};
+
+PtFeedback* pt_feedback_alloc(void) {
+    PtFeedback* feedback = malloc(sizeof(PtFeedback));
+    feedback->notifications = furi_record_open(RECORD_NOTIFICATION);
+
+    feedback->sequences[PtFeedbackLearned] = &pt_feedback_learned;
+    feedback->sequences[PtFeedbackArmed] = &sequence_blink_green_10;
+    feedback->sequences[PtFeedbackFired] = &pt_feedback_fired;
+    feedback->sequences[PtFeedbackCancelled] = &sequence_blink_red_10;
+    feedback->sequences[PtFeedbackUpgraded] = &sequence_blink_green_100;
+    feedback->sequences[PtFeedbackImported] = &sequence_success;
+    feedback->sequences[PtFeedbackImportFailed] = &sequence_error;
+    feedback->sequences[PtFeedbackNotStored] = &sequence_error;
+    return feedback;
+}
+
+void pt_feedback_free(PtFeedback* feedback) {
+    furi_assert(feedback);
+    furi_record_close(RECORD_NOTIFICATION);
+    free(feedback);
+}
+
+void pt_feedback_set(
+    PtFeedback* feedback,
+    PtFeedbackEvent event,
+    const NotificationSequence* sequence) {
+    furi_assert(feedback);
+    furi_check(event < PtFeedbackEventNum);
+    feedback->sequences[event] = sequence;
+}
+
+// Only queues the sequence, notification_message never waits for it to play
+void pt_feedback_play(PtFeedback* feedback, PtFeedbackEvent event) {
+    if(!feedback) return;
+    furi_check(event < PtFeedbackEventNum);
+    const NotificationSequence* sequence = feedback->sequences[event];
+    if(sequence) {
+        notification_message(feedback->notifications, sequence);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <notification/notification_messages.h>
+
+// User feedback goes out as notification sequences, which the notification service
+// plays on its own thread, so it is safe to trigger from timer and worker callbacks
+// and nothing ever sleeps while the vibro or LED is on.
+
+typedef enum {
+    PtFeedbackLearned, // A signal was captured on the learn screen
+    PtFeedbackArmed, // A countdown started
+    PtFeedbackFired, // A countdown elapsed and its signal went out
+    PtFeedbackCancelled, // A running countdown was stopped with Back
+    PtFeedbackUpgraded, // Background analysis decoded stored raw captures
+    PtFeedbackImported, // A button was imported from an Infrared app file
+    PtFeedbackImportFailed, // The file or the button picked from it couldn't be used
+    PtFeedbackNotStored, // A capture didn't fit in the slot and was dropped
+    PtFeedbackEventNum,
+} PtFeedbackEvent;
+
+typedef struct PtFeedback PtFeedback;
+
+PtFeedback* pt_feedback_alloc(void);
+void pt_feedback_free(PtFeedback* feedback);
+
+// NULL turns the event's feedback off
+void pt_feedback_set(
+    PtFeedback* feedback,
+    PtFeedbackEvent event,
+    const NotificationSequence* sequence);
+void pt_feedback_play(PtFeedback* feedback, PtFeedbackEvent event);
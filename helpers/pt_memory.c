@@ -0,0 +1,39 @@
+#include "pt_memory.h"
+
+#define TAG "PT"
+
+static size_t pt_memory_start_free = 0;
+static size_t pt_memory_lowest_free = 0;
+
+void pt_memory_init(void) {
+    pt_memory_start_free = memmgr_get_free_heap();
+    pt_memory_lowest_free = pt_memory_start_free;
+}
+
+// Called from several threads, a lost update only makes the peak a sample less exact
+void pt_memory_sample(void) {
+    size_t free = memmgr_get_free_heap();
+    if(free < pt_memory_lowest_free) pt_memory_lowest_free = free;
+}
+
+// The heap fragments, so what counts is the largest single block and not the total
+bool pt_memory_can_alloc(size_t size) {
+    pt_memory_sample();
+    return size + PT_MEMORY_RESERVE <= memmgr_heap_get_max_free_block();
+}
+
+bool pt_memory_low(void) {
+    pt_memory_sample();
+    return memmgr_get_free_heap() < PT_MEMORY_LOW;
+}
+
+void pt_memory_log(void) {
+    size_t end_free = memmgr_get_free_heap();
+    FURI_LOG_I(
+        TAG,
+        "Heap: %lu free at start, %lu at lowest, %lu at exit, peak use %lu bytes",
+        (uint32_t)pt_memory_start_free,
+        (uint32_t)pt_memory_lowest_free,
+        (uint32_t)end_free,
+        (uint32_t)(pt_memory_start_free - MIN(pt_memory_lowest_free, pt_memory_start_free)));
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <furi.h>
+
+// Watches the heap over one session. The app's own share can't be read directly, so it
+// is taken as how far free heap dropped below what was free when the app started.
+
+#define PT_MEMORY_RESERVE 4096 // Kept free for the system, GUI and IR worker on every check
+#define PT_MEMORY_LOW     (8 * 1024) // Below this much free heap caches are released
+
+void pt_memory_init(void);
+void pt_memory_sample(void);
+bool pt_memory_can_alloc(size_t size);
+bool pt_memory_low(void);
+void pt_memory_log(void);
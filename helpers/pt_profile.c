@@ -0,0 +1,83 @@
+#include "pt_profile.h"
+
+#ifdef PT_PROFILE
+
+#include <furi_hal_cortex.h>
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} PtProfileStats;
+
+static PtProfileStats pt_profile_stats[PtProfileSlotNum];
+static volatile bool pt_profile_hud = false;
+static volatile uint32_t pt_profile_late_ms = 0;
+
+// Frames are counted in one second windows
+static uint32_t pt_profile_window_start = 0;
+static uint32_t pt_profile_window_frames = 0;
+static uint32_t pt_profile_fps = 0;
+
+uint32_t pt_profile_begin(void) {
+    return DWT->CYCCNT;
+}
+
+void pt_profile_end(PtProfileSlot slot, uint32_t start) {
+    uint32_t cycles = DWT->CYCCNT - start;
+    PtProfileStats* stats = &pt_profile_stats[slot];
+
+    if(!stats->count || cycles < stats->min_cycles) stats->min_cycles = cycles;
+    if(cycles > stats->max_cycles) stats->max_cycles = cycles;
+    stats->total_cycles += cycles;
+    stats->count++;
+}
+
+void pt_profile_timer_jitter(uint32_t late_ms) {
+    pt_profile_late_ms = late_ms;
+}
+
+bool pt_profile_input(const InputEvent* event) {
+    if(event->key == InputKeyBack && event->type == InputTypeLong) {
+        pt_profile_hud = !pt_profile_hud;
+        return true;
+    }
+    return false;
+}
+
+void pt_profile_draw_hud(Canvas* canvas, PtProfileSlot slot) {
+    uint32_t now = furi_get_tick();
+    pt_profile_window_frames++;
+    if(now - pt_profile_window_start >= furi_kernel_get_tick_frequency()) {
+        pt_profile_fps = pt_profile_window_frames;
+        pt_profile_window_frames = 0;
+        pt_profile_window_start = now;
+    }
+
+    if(!pt_profile_hud) return;
+
+    const PtProfileStats* stats = &pt_profile_stats[slot];
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    char line[2][24];
+    snprintf(
+        line[0],
+        sizeof(line[0]),
+        "%lu/%lu/%lu",
+        stats->min_cycles / cycles_per_us,
+        stats->count ? (uint32_t)(stats->total_cycles / stats->count) / cycles_per_us : 0,
+        stats->max_cycles / cycles_per_us);
+    snprintf(line[1], sizeof(line[1]), "%lufps +%lums", pt_profile_fps, pt_profile_late_ms);
+
+    canvas_set_font(canvas, FontSecondary);
+    uint8_t width =
+        MAX(canvas_string_width(canvas, line[0]), canvas_string_width(canvas, line[1]));
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 0, width + 2, 19);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_frame(canvas, 0, 0, width + 2, 19);
+    canvas_draw_str(canvas, 1, 8, line[0]);
+    canvas_draw_str(canvas, 1, 17, line[1]);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/canvas.h>
+#include <input/input.h>
+
+// Define PT_PROFILE to time the hot callbacks with the cycle counter. Holding Back on
+// any view toggles a small overlay with min/avg/max microseconds of that view's
+// callback, frames per second and the lateness of the last countdown tick. Without it
+// every call below compiles to nothing.
+
+typedef enum {
+    PtProfileCountdownDraw,
+    PtProfileTimeInputDraw,
+    PtProfileTimeInputProcess,
+    PtProfileIrRx,
+    PtProfileSlotNum,
+} PtProfileSlot;
+
+#ifdef PT_PROFILE
+
+uint32_t pt_profile_begin(void);
+void pt_profile_end(PtProfileSlot slot, uint32_t start);
+void pt_profile_timer_jitter(uint32_t late_ms);
+bool pt_profile_input(const InputEvent* event);
+void pt_profile_draw_hud(Canvas* canvas, PtProfileSlot slot);
+
+#else
+
+#define pt_profile_begin()                0
+#define pt_profile_end(slot, start)       UNUSED(start)
+#define pt_profile_timer_jitter(late_ms)  UNUSED(late_ms)
+#define pt_profile_input(event)           false
+#define pt_profile_draw_hud(canvas, slot) UNUSED(canvas)
+
+#endif
@@ -0,0 +1,75 @@
+#include "pt_trace.h"
+
+#ifdef PT_TRACE
+
+#include <storage/storage.h>
+
+#define TAG "PT"
+
+#define PT_TRACE_MASK (PT_TRACE_SIZE - 1)
+
+typedef struct {
+    uint32_t tick;
+    uint32_t event;
+    uint32_t arg0;
+    uint32_t arg1;
+} PtTraceRecord;
+
+static PtTraceRecord pt_trace_ring[PT_TRACE_SIZE];
+static uint32_t pt_trace_head = 0;
+
+static const char* const pt_trace_formats[PtTraceEventNum] = {
+    [PtTraceRxProtocol] = "rx protocol=%lu repeat=%lu",
+    [PtTraceRxDecoded] = "rx address=0x%lX command=0x%lX",
+    [PtTraceRxRaw] = "rx raw timings=%lu %lu",
+    [PtTraceSignalSaved] = "saved steps=%lu decoded=%lu",
+    [PtTraceTick] = "tick remaining=%lums late=%lu",
+    [PtTraceFireStart] = "fire steps=%lu deadline=%lu",
+    [PtTraceFireStep] = "fire step=%lu late=%lu",
+    [PtTraceFireDone] = "fire sent=%lu took=%lu",
+    [PtTraceAnalysisDone] = "analysis timings=%lu decoded=%lu",
+    [PtTraceTriggered] = "trigger fingerprint=%08lX latency=%lu",
+};
+
+// Safe from any thread or interrupt, writers claim a slot with a single atomic add
+void pt_trace(PtTraceEvent event, uint32_t arg0, uint32_t arg1) {
+    uint32_t index = __atomic_fetch_add(&pt_trace_head, 1, __ATOMIC_RELAXED);
+    PtTraceRecord* record = &pt_trace_ring[index & PT_TRACE_MASK];
+    record->tick = furi_get_tick();
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+}
+
+void pt_trace_dump(void) {
+    uint32_t head = __atomic_load_n(&pt_trace_head, __ATOMIC_ACQUIRE);
+    uint32_t first = head > PT_TRACE_SIZE ? head - PT_TRACE_SIZE : 0;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool to_file = storage_file_open(file, PT_TRACE_DUMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    FuriString* line = furi_string_alloc();
+
+    FURI_LOG_I(TAG, "Trace: %lu events, %lu dropped", head, first);
+    for(uint32_t i = first; i < head; i++) {
+        const PtTraceRecord* record = &pt_trace_ring[i & PT_TRACE_MASK];
+        if(record->event >= PtTraceEventNum) continue;
+
+        furi_string_printf(line, "%lu ", record->tick);
+        furi_string_cat_printf(
+            line, pt_trace_formats[record->event], record->arg0, record->arg1);
+        FURI_LOG_D(TAG, "%s", furi_string_get_cstr(line));
+
+        if(to_file) {
+            furi_string_push_back(line, '\n');
+            storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line));
+        }
+    }
+
+    furi_string_free(line);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+#endif
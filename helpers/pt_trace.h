@@ -0,0 +1,41 @@
+#pragma once
+
+#include <furi.h>
+
+// Define PT_TRACE to record hot path events into a fixed size ring instead of logging
+// them. Each record is just an event id, the tick and two arguments, the text is only
+// produced by pt_trace_dump when the app exits. Without it pt_trace compiles to nothing.
+
+#define PT_TRACE_SIZE      128 // Must be a power of two
+#define PT_TRACE_DUMP_PATH APP_DATA_PATH("trace.log")
+
+typedef enum {
+    PtTraceRxProtocol, // protocol, repeat
+    PtTraceRxDecoded, // address, command
+    PtTraceRxRaw, // timings, 0
+    PtTraceSignalSaved, // macro steps, is_decoded
+    PtTraceTick, // remaining ms, ticks late
+    PtTraceFireStart, // macro steps, deadline tick
+    PtTraceFireStep, // step, ticks late
+    PtTraceFireDone, // steps sent, ticks spent
+    PtTraceAnalysisDone, // timings, decoded
+    PtTraceTriggered, // trigger fingerprint, ticks until the countdown was running
+    PtTraceEventNum,
+} PtTraceEvent;
+
+#ifdef PT_TRACE
+
+void pt_trace(PtTraceEvent event, uint32_t arg0, uint32_t arg1);
+void pt_trace_dump(void);
+
+#else
+
+// The arguments only go through sizeof, so they count as used but are never evaluated
+#define pt_trace(event, arg0, arg1) \
+    do {                            \
+        (void)sizeof(arg0);         \
+        (void)sizeof(arg1);         \
+    } while(0)
+#define pt_trace_dump()
+
+#endif
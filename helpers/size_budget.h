@@ -0,0 +1,9 @@
+#pragma once
+
+// Fails the build when a structure grows past the size it was laid out for. The budgets
+// sit next to each definition, raise one in the same change that needs the extra bytes.
+// Budgets are for the 32 bit target, host builds have wider pointers and skip them.
+#define PT_SIZE_BUDGET(type, bytes)                    \
+    _Static_assert(                                    \
+        sizeof(void*) != 4 || sizeof(type) <= (bytes), \
+        #type " grew past its " #bytes " byte budget")
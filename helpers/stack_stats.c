@@ -0,0 +1,60 @@
+#include "stack_stats.h"
+
+#ifdef PT_STACK_STATS
+
+#define TAG "PT"
+
+typedef struct {
+    const char* thread_name;
+    uint32_t samples;
+    uint32_t min_free; // Bytes, the thread's high-water mark is only ever going down
+} PtStackStats;
+
+static PtStackStats pt_stack_stats[PtStackSiteNum];
+
+static const char* const pt_stack_site_names[PtStackSiteNum] = {
+    [PtStackApp] = "app",
+    [PtStackDraw] = "draw",
+    [PtStackTimer] = "timer",
+    [PtStackFire] = "fire",
+    [PtStackIrRx] = "ir rx",
+    [PtStackAnalysis] = "analysis",
+    [PtStackJournal] = "journal",
+};
+
+// Each site only ever runs on one thread, so the counters are never written concurrently
+void pt_stack_sample(PtStackSite site) {
+    FuriThreadId thread = furi_thread_get_current_id();
+    uint32_t free = furi_thread_get_stack_space(thread);
+    PtStackStats* stats = &pt_stack_stats[site];
+
+    if(!stats->samples || free < stats->min_free) stats->min_free = free;
+    stats->thread_name = furi_thread_get_name(thread);
+    stats->samples++;
+}
+
+void pt_stack_log(void) {
+    for(uint8_t site = 0; site < PtStackSiteNum; site++) {
+        const PtStackStats* stats = &pt_stack_stats[site];
+        if(!stats->samples) continue;
+
+        if(stats->min_free < PT_STACK_MARGIN) {
+            FURI_LOG_W(
+                TAG,
+                "Stack %s on %s: only %lu bytes left",
+                pt_stack_site_names[site],
+                stats->thread_name ? stats->thread_name : "?",
+                stats->min_free);
+        } else {
+            FURI_LOG_I(
+                TAG,
+                "Stack %s on %s: %lu bytes left, %lu samples",
+                pt_stack_site_names[site],
+                stats->thread_name ? stats->thread_name : "?",
+                stats->min_free,
+                stats->samples);
+        }
+    }
+}
+
+#endif
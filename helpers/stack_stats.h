@@ -0,0 +1,34 @@
+#pragma once
+
+#include <furi.h>
+
+// Define PT_STACK_STATS to find out how close app code gets to the end of each thread's
+// stack. Every site reads the high-water mark of the thread it runs on as it returns, so
+// its deepest call is included, and the least free stack seen per site is logged when the
+// app exits. Run it with PT_INPUT_REPLAY for numbers from a scripted session. Without it
+// every call below compiles to nothing.
+
+#define PT_STACK_MARGIN 256 // Sites with less free stack than this are logged as warnings
+
+typedef enum {
+    PtStackApp, // Input and custom events, and the scenes they switch, on the app thread
+    PtStackDraw, // Draw callbacks on the GUI thread
+    PtStackTimer, // Countdown ticks and fire scheduling, learn idle timeout on the timer thread
+    PtStackFire, // Macro timelines on the countdown's fire thread
+    PtStackIrRx, // Capture callback on the infrared worker thread
+    PtStackAnalysis,
+    PtStackJournal,
+    PtStackSiteNum,
+} PtStackSite;
+
+#ifdef PT_STACK_STATS
+
+void pt_stack_sample(PtStackSite site);
+void pt_stack_log(void);
+
+#else
+
+#define pt_stack_sample(site)
+#define pt_stack_log()
+
+#endif
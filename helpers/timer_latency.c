@@ -0,0 +1,61 @@
+#include "timer_latency.h"
+
+#define TAG "PT"
+
+void timer_latency_reset(TimerLatency* latency) {
+    furi_assert(latency);
+    memset(latency, 0, sizeof(TimerLatency));
+}
+
+void timer_latency_add(TimerLatency* latency, uint32_t late_ticks) {
+    furi_assert(latency);
+
+    uint8_t bucket = 0;
+    while(late_ticks >> bucket && bucket < TIMER_LATENCY_BUCKETS - 1) {
+        bucket++;
+    }
+
+    latency->buckets[bucket]++;
+    latency->count++;
+    if(late_ticks > latency->max) latency->max = late_ticks;
+}
+
+// Returns the upper bound of the bucket holding the percentile, so it errs on the late side
+uint32_t timer_latency_percentile(const TimerLatency* latency, uint8_t percent) {
+    furi_assert(latency);
+    if(!latency->count) return 0;
+
+    uint32_t target = (latency->count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for(uint8_t bucket = 0; bucket < TIMER_LATENCY_BUCKETS - 1; bucket++) {
+        seen += latency->buckets[bucket];
+        if(seen >= target) return MIN((1UL << bucket) - 1, latency->max);
+    }
+    return latency->max;
+}
+
+void timer_latency_log(const TimerLatency* latency, const char* name) {
+    furi_assert(latency);
+    if(!latency->count) return;
+
+    FURI_LOG_I(
+        TAG,
+        "%s latency: %lu samples, p50 %lu p95 %lu max %lu ticks",
+        name,
+        latency->count,
+        timer_latency_percentile(latency, 50),
+        timer_latency_percentile(latency, 95),
+        latency->max);
+    FURI_LOG_I(
+        TAG,
+        "%s histogram: %lu %lu %lu %lu %lu %lu %lu %lu",
+        name,
+        latency->buckets[0],
+        latency->buckets[1],
+        latency->buckets[2],
+        latency->buckets[3],
+        latency->buckets[4],
+        latency->buckets[5],
+        latency->buckets[6],
+        latency->buckets[7]);
+}
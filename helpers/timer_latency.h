@@ -0,0 +1,18 @@
+#pragma once
+
+#include <furi.h>
+
+// Power of two histogram of how late timer callbacks arrive, in ticks. Bucket 0 holds
+// on-time callbacks, bucket n holds [2^(n-1), 2^n) and the last one everything above.
+#define TIMER_LATENCY_BUCKETS 8
+
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint32_t buckets[TIMER_LATENCY_BUCKETS];
+} TimerLatency;
+
+void timer_latency_reset(TimerLatency* latency);
+void timer_latency_add(TimerLatency* latency, uint32_t late_ticks);
+uint32_t timer_latency_percentile(const TimerLatency* latency, uint8_t percent);
+void timer_latency_log(const TimerLatency* latency, const char* name);
@@ -1,5 +1,8 @@
 #include "pause_timer.h"
 #include "views.h"
+#include <furi_hal_rtc.h>
+#include <datetime/datetime.h>
+#include <dialogs/dialogs.h>
 
 #define TAG "PauseTimerApp"
 
@@ -9,6 +12,45 @@ void countdown_back_callback(void* context) {
     scene_manager_previous_scene(app->scene_manager);
 }
 
+// Starts a new step in the selected slot. A plain LEARN replaces the slot's macro,
+// a long LEARN chains another step onto it.
+static IrSignalStorage* pause_timer_begin_step(PauseTimerApp* app) {
+    if(!app->learn_append) {
+        ir_bank_clear_slot(&app->bank, app->bank.selected);
+    }
+    return ir_macro_append(ir_bank_selected_macro(&app->bank), app->step_delay_ms);
+}
+
+// Indexes the step begin_step handed out once it is filled in, or drops it if it ended
+// up empty so no blank step is left behind. Returns whether the step was kept.
+static bool pause_timer_commit_step(PauseTimerApp* app, IrSignalStorage* signal) {
+    uint8_t slot = app->bank.selected;
+    IrMacro* macro = ir_bank_selected_macro(&app->bank);
+    bool kept = ir_signal_is_set(signal);
+
+    if(!kept) {
+        ir_macro_remove_last(macro);
+    } else {
+        uint8_t step = macro->count - 1;
+        ir_bank_index_step(&app->bank, slot, step);
+
+        // Raw captures get a second look in the background, see analysis_apply_results.
+        // Decoding allocates a decoder per job, when the heap is short the raw signal stays.
+        if(signal->kind == IrSignalKindRaw && !pt_memory_low()) {
+            IrAnalysisJob job = {
+                .slot = slot,
+                .step = step,
+                .fingerprint = signal->fingerprint,
+                .timings = signal->raw.timings,
+                .timings_size = signal->raw.timings_size,
+            };
+            ir_analysis_submit(app->analysis, &job);
+        }
+    }
+    pt_trace(PtTraceSignalSaved, macro->count, ir_signal_is_decoded(signal));
+    return kept;
+}
+
 // Callback from IR learn view when signal is learned
 void ir_learn_signal_learned_callback(void* context) {
     PauseTimerApp* app = context;
@@ -16,81 +58,263 @@ void ir_learn_signal_learned_callback(void* context) {
     // Get the learned signal directly from the view
     IrLearnResult result = ir_learn_get_result(app->ir_learn);
 
-    // Free previous signal if exists
-    if(app->learned_ir_signal.raw_timings) {
-        free(app->learned_ir_signal.raw_timings);
-        app->learned_ir_signal.raw_timings = NULL;
-        app->learned_ir_signal.raw_timings_size = 0;
-    }
-
-    // Copy the learned signal
-    if(result.has_signal) {
-        app->learned_ir_signal.has_signal = true;
-        app->learned_ir_signal.is_decoded = result.is_decoded;
-
-        if(result.is_decoded) {
-            app->learned_ir_signal.decoded_message = result.decoded_message;
-            FURI_LOG_D(
-                TAG,
-                "Decoded signal saved: protocol=%d, address=0x%lX, command=0x%lX",
-                result.decoded_message.protocol,
-                result.decoded_message.address,
-                result.decoded_message.command);
-        } else {
-            if(result.raw_timings && result.raw_timings_size > 0) {
-                app->learned_ir_signal.raw_timings =
-                    malloc(result.raw_timings_size * sizeof(uint32_t));
-                if(app->learned_ir_signal.raw_timings) {
-                    memcpy(
-                        app->learned_ir_signal.raw_timings,
-                        result.raw_timings,
-                        result.raw_timings_size * sizeof(uint32_t));
-                    app->learned_ir_signal.raw_timings_size = result.raw_timings_size;
-                    app->learned_ir_signal.frequency = result.frequency;
-                    app->learned_ir_signal.duty_cycle = result.duty_cycle;
-                    FURI_LOG_D(TAG, "Raw signal saved: %d timings", (int)result.raw_timings_size);
-                }
+    if(!ir_signal_is_set(&result.signal)) {
+        scene_manager_previous_scene(app->scene_manager);
+        return;
+    }
+
+    // The capture screen offered to change the wait before an appended step
+    if(app->learn_append) {
+        app->step_delay_ms = ir_learn_get_step_delay(app->ir_learn);
+    }
+    IrSignalStorage* signal = pause_timer_begin_step(app);
+    bool stored = false;
+
+    // Copy the learned signal, raw timings move from the view into the bank
+    if(signal) {
+        *signal = result.signal;
+
+        if(signal->kind == IrSignalKindRaw) {
+            signal->raw.timings = ir_bank_alloc_timings(
+                &app->bank, app->bank.selected, result.signal.raw.timings_size);
+            if(signal->raw.timings) {
+                memcpy(
+                    signal->raw.timings,
+                    result.signal.raw.timings,
+                    result.signal.raw.timings_size * sizeof(uint32_t));
+            } else {
+                // Didn't fit in the slot
+                signal->kind = IrSignalKindNone;
             }
         }
+        stored = pause_timer_commit_step(app, signal);
+    }
+
+    // The macro had no free step or the slot no room for the timings. The capture was
+    // already confirmed, so say it wasn't kept after all.
+    if(!stored) {
+        FURI_LOG_W(TAG, "Learned signal didn't fit in slot %d", app->bank.selected + 1);
+        pt_feedback_play(app->feedback, PtFeedbackNotStored);
     }
 
     scene_manager_previous_scene(app->scene_manager);
 }
 
+// Imports one button of an Infrared app file into the selected slot, the same way a
+// capture from the learn screen is stored
+IrImportStatus pause_timer_import_signal(PauseTimerApp* app, const char* path, const char* name) {
+    // Raw data is parsed straight into the slot's free timings, so even long universal
+    // remote signals need no extra buffer, and a file that can't be used leaves the slot
+    // as it was
+    uint8_t slot = app->bank.selected;
+    size_t capacity;
+    uint32_t* timings = ir_bank_peek_timings(&app->bank, slot, &capacity);
+    IrSignalStorage imported;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    IrImportStatus status = ir_import_signal(storage, path, name, timings, capacity, &imported);
+
+    // A plain LEARN replaces the slot, so the signal may use all of it and not just the
+    // free tail. Check it against the whole slot without storing anything, and only parse
+    // it for real once the slot has been cleared.
+    bool parse_again = false;
+    if(status == IrImportErrorTooLong && !app->learn_append) {
+        status = ir_import_signal(storage, path, name, NULL, IR_BANK_SLOT_TIMINGS, &imported);
+        parse_again = status == IrImportOk;
+    }
+
+    IrSignalStorage* signal = NULL;
+    if(status == IrImportOk) {
+        signal = pause_timer_begin_step(app);
+        // The macro has no free step, as far as the user is concerned the slot is full
+        if(!signal) status = IrImportErrorTooLong;
+    }
+    if(signal && parse_again) {
+        timings = ir_bank_peek_timings(&app->bank, slot, &capacity);
+        status = ir_import_signal(storage, path, name, timings, capacity, &imported);
+        // Only a file changed since the check gets here, drop the step begin_step added
+        if(status != IrImportOk) {
+            pause_timer_commit_step(app, signal);
+            signal = NULL;
+        }
+    }
+    furi_record_close(RECORD_STORAGE);
+
+    FURI_LOG_I(TAG, "Import %s: %s", name, ir_import_status_text(status));
+    if(!signal) return status;
+
+    *signal = imported;
+    if(signal->kind == IrSignalKindRaw) {
+        // Claim the parsed timings, a plain LEARN cleared the slot so they move to its start
+        signal->raw.timings = ir_bank_alloc_timings(&app->bank, slot, imported.raw.timings_size);
+        memmove(
+            signal->raw.timings,
+            imported.raw.timings,
+            imported.raw.timings_size * sizeof(uint32_t));
+    }
+    signal->fingerprint = ir_fingerprint_signal(signal);
+    pause_timer_commit_step(app, signal);
+    return status;
+}
+
+// Callback from IR learn view when Right asks for a file to import from
+void ir_learn_import_callback(void* context) {
+    PauseTimerApp* app = context;
+    scene_manager_next_scene(app->scene_manager, PauseTimerSceneIrImport);
+}
+
+// Runs on the IR worker thread when listening, the countdown is started from the GUI thread
+void ir_learn_trigger_callback(void* context, uint32_t fingerprint, bool picked) {
+    PauseTimerApp* app = context;
+    if(picked) {
+        app->trigger_fingerprint = fingerprint;
+        return;
+    }
+    app->trigger_tick = furi_get_tick();
+    view_dispatcher_send_custom_event(app->view_dispatcher, PTCustomEventTriggered);
+}
+
 // Callback from IR learn view when user cancels
 void ir_learn_back_callback(void* context) {
     PauseTimerApp* app = context;
     scene_manager_previous_scene(app->scene_manager);
 }
 
+// Callback from IR learn view to find out if a fresh capture is already stored
+bool ir_learn_match_callback(
+    void* context,
+    uint32_t fingerprint,
+    uint8_t* slot,
+    uint8_t* step) {
+    PauseTimerApp* app = context;
+    return ir_bank_find(&app->bank, fingerprint, slot, step);
+}
+
+// Next time the RTC reads hour:minute, tomorrow if that has already gone by today
+static uint32_t next_wall_clock_time(uint8_t hour, uint8_t minute) {
+    DateTime now;
+    furi_hal_rtc_get_datetime(&now);
+    uint32_t now_ts = datetime_datetime_to_timestamp(&now);
+
+    DateTime target = now;
+    target.hour = hour;
+    target.minute = minute;
+    target.second = 0;
+    uint32_t target_ts = datetime_datetime_to_timestamp(&target);
+
+    if(target_ts <= now_ts) {
+        target_ts += 24 * 60 * 60;
+    }
+    return target_ts;
+}
+
 // Callback from numpad when START is pressed
-static void numpad_start_callback(void* context, uint16_t timer_val) {
+static void
+    numpad_start_callback(void* context, uint16_t timer_val, bool repeat, bool wall_clock) {
     PauseTimerApp* app = context;
 
-    app->current_timer_val = timer_val;
+    if(wall_clock) {
+        // timer_val is HHMM, a fixed time of day only ever fires once
+        app->current_fire_at = next_wall_clock_time(timer_val / 100, timer_val % 100);
+        app->current_duration_s = 0;
+        app->current_repeat = false;
+    } else {
+        // Convert from MMSS format to total seconds
+        app->current_fire_at = 0;
+        app->current_duration_s = (timer_val / 100) * 60 + timer_val % 100;
+        app->current_repeat = repeat;
+    }
+    app->current_start_tick = 0;
     scene_manager_next_scene(app->scene_manager, PauseTimerSceneCountdown);
 }
 
+// Callback from numpad when ARM is pressed, the countdown waits for the trigger button
+static void numpad_arm_callback(void* context, uint16_t timer_val, bool pick_trigger) {
+    PauseTimerApp* app = context;
+
+    app->current_fire_at = 0;
+    app->current_duration_s = (timer_val / 100) * 60 + timer_val % 100;
+    app->current_repeat = false;
+    if(pick_trigger) {
+        app->trigger_fingerprint = IR_FINGERPRINT_NONE;
+    }
+    scene_manager_next_scene(app->scene_manager, PauseTimerSceneIrListen);
+}
+
+// Callback from numpad when the slot key is pressed
+static void numpad_slot_callback(void* context, uint8_t slot) {
+    PauseTimerApp* app = context;
+    ir_bank_select(&app->bank, slot);
+}
+
+// Callback from numpad when the slot key is held
+static void numpad_output_callback(void* context, bool dual_output) {
+    PauseTimerApp* app = context;
+    app->dual_output = dual_output;
+}
+
 // Callback from numpad when LEARN is pressed
-static void numpad_learn_callback(void* context) {
+static void numpad_learn_callback(void* context, bool append) {
     PauseTimerApp* app = context;
 
+    app->learn_append = append;
     scene_manager_next_scene(app->scene_manager, PauseTimerSceneIrLearn);
 }
 
-void free_ir_signal(IrSignalStorage* signal) {
-    if(signal->raw_timings) {
-        free(signal->raw_timings);
-        signal->raw_timings = NULL;
-        signal->raw_timings_size = 0;
+// Runs on the analysis thread, hand over to the GUI thread before touching the bank
+static void analysis_done_callback(void* context) {
+    PauseTimerApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, PTCustomEventAnalysisDone);
+}
+
+// Upgrade stored signals in place with whatever the analysis worker found
+static void analysis_apply_results(PauseTimerApp* app) {
+    IrAnalysisResult result;
+    bool upgraded = false;
+
+    while(ir_analysis_take_result(app->analysis, &result)) {
+        if(!result.is_decoded) continue;
+        // Skipped if the slot was relearned while the job was queued. The raw timings stay
+        // allocated in the slot until it is cleared.
+        upgraded |= ir_bank_upgrade_step(
+            &app->bank,
+            result.slot,
+            result.step,
+            result.original_fingerprint,
+            &result.decoded_message,
+            result.fingerprint);
+    }
+
+    if(upgraded) {
+        ir_bank_reindex(&app->bank);
+        pt_feedback_play(app->feedback, PtFeedbackUpgraded);
     }
-    signal->has_signal = false;
 }
 
 bool pt_custom_event_callback(void* context, uint32_t event) {
     furi_assert(context);
     PauseTimerApp* app = context;
-    return scene_manager_handle_custom_event(app->scene_manager, event);
+
+    bool consumed = true;
+    if(event == PTCustomEventAnalysisDone) {
+        analysis_apply_results(app);
+    } else {
+        consumed = scene_manager_handle_custom_event(app->scene_manager, event);
+    }
+    pt_stack_sample(PtStackApp);
+    return consumed;
+}
+
+// Runs on the GUI thread whenever the dispatcher has been idle for a second
+void pt_tick_event_callback(void* context) {
+    furi_assert(context);
+    PauseTimerApp* app = context;
+
+    // Views that aren't on screen keep no buffers, the last capture is the one cache to drop
+    if(pt_memory_low()) {
+        size_t released = ir_learn_release_cache(app->ir_learn);
+        if(released) FURI_LOG_W("PT", "Heap low, released %d bytes", (int)released);
+    }
 }
 
 bool pt_back_event_callback(void* context) {
@@ -103,12 +327,15 @@ PauseTimerApp* pause_timer_app_alloc() {
     PauseTimerApp* app = malloc(sizeof(PauseTimerApp));
 
     app->gui = furi_record_open(RECORD_GUI);
+    app->feedback = pt_feedback_alloc();
 
     // dispatcher
     app->view_dispatcher = view_dispatcher_alloc();
     view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
     view_dispatcher_set_custom_event_callback(app->view_dispatcher, pt_custom_event_callback);
     view_dispatcher_set_navigation_event_callback(app->view_dispatcher, pt_back_event_callback);
+    view_dispatcher_set_tick_event_callback(
+        app->view_dispatcher, pt_tick_event_callback, furi_ms_to_ticks(1000));
     view_dispatcher_attach_to_gui(app->view_dispatcher, app->gui, ViewDispatcherTypeFullscreen);
 
     app->scene_manager = scene_manager_alloc(&pause_timer_scene_handlers, app);
@@ -125,15 +352,31 @@ PauseTimerApp* pause_timer_app_alloc() {
 
     // ir learn view
     app->ir_learn = ir_learn_alloc();
+    ir_learn_set_feedback(app->ir_learn, app->feedback);
+    ir_learn_set_max_timings(app->ir_learn, IR_BANK_SLOT_TIMINGS);
     view_dispatcher_add_view(
         app->view_dispatcher, PTViewIrLearn, ir_learn_get_view(app->ir_learn));
 
-    app->learned_ir_signal.has_signal = false;
-    app->learned_ir_signal.is_decoded = false;
-    app->learned_ir_signal.raw_timings = NULL;
-    app->learned_ir_signal.raw_timings_size = 0;
-    app->learned_ir_signal.frequency = 38000;
-    app->learned_ir_signal.duty_cycle = 0.33f;
+    // submenu, lists the buttons of an imported file
+    app->submenu = submenu_alloc();
+    view_dispatcher_add_view(app->view_dispatcher, PTViewSubmenu, submenu_get_view(app->submenu));
+    app->import_path = furi_string_alloc_set(IR_IMPORT_FOLDER);
+    app->import_names = NULL;
+    app->import_name_count = 0;
+
+    ir_bank_init(&app->bank);
+    ir_bank_log_usage(&app->bank);
+    app->analysis = ir_analysis_alloc(analysis_done_callback, app);
+    app->journal = fire_journal_alloc();
+    app->learn_append = false;
+    app->step_delay_ms = IR_MACRO_DEFAULT_GAP_MS;
+    app->current_repeat = false;
+    app->current_start_tick = 0;
+    app->trigger_fingerprint = IR_FINGERPRINT_NONE;
+    app->trigger_tick = 0;
+    app->dual_output = false;
+    app->current_duration_s = 0;
+    app->current_fire_at = 0;
 
     return app;
 }
@@ -143,41 +386,84 @@ void pause_timer_app_free(PauseTimerApp* app) {
 
     view_dispatcher_stop(app->view_dispatcher);
 
+    // Stop the analysis worker first, its jobs point into the signal bank
+    ir_analysis_free(app->analysis);
+
     // Remove views
     view_dispatcher_remove_view(app->view_dispatcher, PTViewTimeInput);
     view_dispatcher_remove_view(app->view_dispatcher, PTViewCountdown);
     view_dispatcher_remove_view(app->view_dispatcher, PTViewIrLearn);
+    view_dispatcher_remove_view(app->view_dispatcher, PTViewSubmenu);
 
     // Free view objects
     time_input_free(app->time_input);
     countdown_utils_free(app->countdown);
     ir_learn_free(app->ir_learn);
+    submenu_free(app->submenu);
+    furi_string_free(app->import_path);
+
+    // After the countdown is gone so no fire can be appended to a freed journal
+    fire_journal_free(app->journal);
+    pt_feedback_free(app->feedback);
 
     // Free managers
     scene_manager_free(app->scene_manager);
     view_dispatcher_free(app->view_dispatcher);
 
     // Other resources
-    free_ir_signal(&app->learned_ir_signal);
+    ir_bank_log_usage(&app->bank);
+    ir_bank_deinit(&app->bank);
     furi_record_close(RECORD_GUI);
     free(app);
 }
 
+static void pause_timer_show_low_memory(void) {
+    DialogsApp* dialogs = furi_record_open(RECORD_DIALOGS);
+    DialogMessage* message = dialog_message_alloc();
+    dialog_message_set_header(message, "Not enough memory", 64, 8, AlignCenter, AlignTop);
+    dialog_message_set_text(
+        message, "Close other apps\nand try again", 64, 32, AlignCenter, AlignCenter);
+    dialog_message_set_buttons(message, NULL, "OK", NULL);
+    dialog_message_show(dialogs, message);
+    dialog_message_free(message);
+    furi_record_close(RECORD_DIALOGS);
+}
+
 int32_t pause_timer_app(void* p) {
     UNUSED(p);
+
+    // The signal bank is the one large block, better to say so than crash half way through
+    pt_memory_init();
+    if(!pt_memory_can_alloc(ir_bank_memory_size())) {
+        FURI_LOG_E("PT", "Only %d bytes free", (int)memmgr_get_free_heap());
+        pause_timer_show_low_memory();
+        return 0;
+    }
+
     PauseTimerApp* app = pause_timer_app_alloc();
 
     time_input_set_start_callback(app->time_input, numpad_start_callback, app);
     time_input_set_learn_callback(app->time_input, numpad_learn_callback, app);
+    time_input_set_slot_callback(app->time_input, numpad_slot_callback, app, IR_BANK_SLOTS);
+    time_input_set_output_callback(app->time_input, numpad_output_callback, app);
+    time_input_set_arm_callback(app->time_input, numpad_arm_callback, app);
 
     scene_manager_set_scene_state(app->scene_manager, PauseTimerSceneMain, PTViewTimeInput);
     scene_manager_next_scene(app->scene_manager, PauseTimerSceneMain);
 
+    // Only does anything when built with PT_INPUT_REPLAY
+    app->input_replay = input_replay_alloc();
+
     FURI_LOG_D("PT", "Running view dispatcher");
     view_dispatcher_run(app->view_dispatcher);
 
+    input_replay_free(app->input_replay);
+    pt_trace_dump();
+    pt_stack_log();
+
     FURI_LOG_D("PT", "Freeing...");
     pause_timer_app_free(app);
+    pt_memory_log();
 
     return 0;
 }
@@ -5,35 +5,69 @@
 #include <gui/gui.h>
 #include <gui/view_dispatcher.h>
 #include <gui/scene_manager.h>
+#include <gui/modules/submenu.h>
+#include <notification/notification_messages.h>
 
 #include "views/time_input.h"
 #include "views/countdown.h"
 #include "views/ir_learn.h"
 #include "scenes/scene.h"
+#include "helpers/ir_signal.h"
+#include "helpers/ir_macro.h"
+#include "helpers/ir_fingerprint.h"
+#include "helpers/ir_bank.h"
+#include "helpers/ir_analysis.h"
+#include "helpers/input_replay.h"
+#include "helpers/pt_trace.h"
+#include "helpers/stack_stats.h"
+#include "helpers/fire_journal.h"
+#include "helpers/ir_import.h"
+#include "helpers/pt_feedback.h"
+#include "helpers/pt_memory.h"
 
-typedef struct {
-    bool is_decoded;
-    bool has_signal;
+#define PT_IMPORT_MAX_NAMES 32 // Buttons listed per file, universal remotes repeat names
 
-    InfraredMessage decoded_message;
-    uint32_t* raw_timings;
-    size_t raw_timings_size;
-    uint32_t frequency;
-    float duty_cycle;
-} IrSignalStorage;
+// Custom events handled by the app itself before they reach the scenes
+typedef enum {
+    PTCustomEventAnalysisDone = 100,
+    PTCustomEventTriggered,
+} PTCustomEvent;
 
 struct PauseTimerApp {
     Gui* gui;
+    PtFeedback* feedback;
     ViewDispatcher* view_dispatcher;
     SceneManager* scene_manager;
     PTTimeInput* time_input;
     CountdownUtils* countdown;
     IrLearnArgs* ir_learn;
-    uint16_t current_timer_val;
-    IrSignalStorage learned_ir_signal;
+    uint32_t current_duration_s;
+    uint32_t current_fire_at; // RTC timestamp for wall clock mode, 0 otherwise
+    bool current_repeat;
+    uint32_t current_start_tick; // Tick the countdown counts from, 0 for when it opens
+    bool dual_output; // Fire on the external module and the internal LED
+    IrBank bank;
+    IrAnalysis* analysis;
+    bool learn_append;
+    uint32_t step_delay_ms; // Wait before an appended step, the last one picked when learning
+    InputReplay* input_replay;
+    FireJournal* journal;
+    Submenu* submenu;
+    FuriString* import_path;
+    char (*import_names)[IR_IMPORT_NAME_LEN]; // Only allocated while the import list is up
+    uint8_t import_name_count;
+    uint32_t trigger_fingerprint; // Signal that starts an armed countdown, none if not picked
+    volatile uint32_t trigger_tick; // When the trigger was last received
 };
 
-void free_ir_signal(IrSignalStorage* signal);
 void countdown_back_callback(void* context);
 void ir_learn_signal_learned_callback(void* context);
 void ir_learn_back_callback(void* context);
+void ir_learn_import_callback(void* context);
+void ir_learn_trigger_callback(void* context, uint32_t fingerprint, bool picked);
+bool ir_learn_match_callback(
+    void* context,
+    uint32_t fingerprint,
+    uint8_t* slot,
+    uint8_t* step);
+IrImportStatus pause_timer_import_signal(PauseTimerApp* app, const char* path, const char* name);
@@ -1,3 +1,5 @@
 ADD_SCENE(pause_timer, main, Main)
 ADD_SCENE(pause_timer, countdown, Countdown)
-ADD_SCENE(pause_timer, ir_learn, IrLearn)
\ No newline at end of file
+ADD_SCENE(pause_timer, ir_learn, IrLearn)
+ADD_SCENE(pause_timer, ir_import, IrImport)
+ADD_SCENE(pause_timer, ir_listen, IrListen)
\ No newline at end of file
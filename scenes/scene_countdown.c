@@ -5,8 +5,11 @@ void pause_timer_scene_countdown_on_enter(void* context) {
     PauseTimerApp* app = context;
 
     CountdownArgs args = {
-        .timer_val = app->current_timer_val,
-        .has_ir_signal = app->learned_ir_signal.has_signal,
+        .duration_s = app->current_duration_s,
+        .fire_at = app->current_fire_at,
+        .has_ir_signal = ir_macro_has_signal(ir_bank_selected_macro(&app->bank)),
+        .repeat = app->current_repeat,
+        .start_tick = app->current_start_tick,
         .app = app,
     };
 
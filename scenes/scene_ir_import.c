@@ -0,0 +1,97 @@
+#include "../pause_timer.h"
+#include "../views.h"
+#include <dialogs/dialogs.h>
+
+// Universal remote files list the same button name once per brand, show it only once
+static void pause_timer_scene_ir_import_name_callback(void* context, const char* name) {
+    PauseTimerApp* app = context;
+    if(app->import_name_count >= PT_IMPORT_MAX_NAMES) return;
+
+    for(uint8_t i = 0; i < app->import_name_count; i++) {
+        if(strcmp(app->import_names[i], name) == 0) return;
+    }
+    strlcpy(app->import_names[app->import_name_count++], name, IR_IMPORT_NAME_LEN);
+}
+
+// The scene is left from on_event, never from inside the submenu's own callback
+static void pause_timer_scene_ir_import_submenu_callback(void* context, uint32_t index) {
+    PauseTimerApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, index);
+}
+
+void pause_timer_scene_ir_import_on_enter(void* context) {
+    PauseTimerApp* app = context;
+
+    FURI_LOG_D("PauseTimer", "Starting IR import scene");
+
+    // Blocks until a file is picked or the browser is closed
+    DialogsApp* dialogs = furi_record_open(RECORD_DIALOGS);
+    DialogsFileBrowserOptions options;
+    dialog_file_browser_set_basic_options(&options, IR_IMPORT_EXTENSION, NULL);
+    options.base_path = IR_IMPORT_FOLDER;
+    bool picked =
+        dialog_file_browser_show(dialogs, app->import_path, app->import_path, &options);
+    furi_record_close(RECORD_DIALOGS);
+
+    submenu_reset(app->submenu);
+    app->import_names = malloc(PT_IMPORT_MAX_NAMES * IR_IMPORT_NAME_LEN);
+    app->import_name_count = 0;
+
+    if(picked) {
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        ir_import_list(
+            storage,
+            furi_string_get_cstr(app->import_path),
+            pause_timer_scene_ir_import_name_callback,
+            app);
+        furi_record_close(RECORD_STORAGE);
+    }
+
+    if(!app->import_name_count) {
+        // Nothing picked or nothing to pick from, back to the learn screen
+        if(picked) {
+            pt_feedback_play(app->feedback, PtFeedbackImportFailed);
+        }
+        scene_manager_previous_scene(app->scene_manager);
+        return;
+    }
+
+    submenu_set_header(app->submenu, "Import button");
+    for(uint8_t i = 0; i < app->import_name_count; i++) {
+        submenu_add_item(
+            app->submenu,
+            app->import_names[i],
+            i,
+            pause_timer_scene_ir_import_submenu_callback,
+            app);
+    }
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, PTViewSubmenu);
+}
+
+bool pause_timer_scene_ir_import_on_event(void* context, SceneManagerEvent event) {
+    PauseTimerApp* app = context;
+    if(event.type != SceneManagerEventTypeCustom) return false;
+    if(event.event >= app->import_name_count) return false;
+
+    IrImportStatus status = pause_timer_import_signal(
+        app, furi_string_get_cstr(app->import_path), app->import_names[event.event]);
+
+    if(status == IrImportOk) {
+        pt_feedback_play(app->feedback, PtFeedbackImported);
+        scene_manager_search_and_switch_to_previous_scene(app->scene_manager, PauseTimerSceneMain);
+    } else {
+        // Stay on the list so another button can be picked
+        pt_feedback_play(app->feedback, PtFeedbackImportFailed);
+        submenu_set_header(app->submenu, ir_import_status_text(status));
+    }
+    return true;
+}
+
+void pause_timer_scene_ir_import_on_exit(void* context) {
+    PauseTimerApp* app = context;
+    submenu_reset(app->submenu);
+    free(app->import_names);
+    app->import_names = NULL;
+    app->import_name_count = 0;
+}
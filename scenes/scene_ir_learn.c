@@ -8,6 +8,20 @@ void pause_timer_scene_ir_learn_on_enter(void* context) {
 
     ir_learn_set_callbacks(
         app->ir_learn, ir_learn_signal_learned_callback, ir_learn_back_callback, app);
+    ir_learn_set_match_callback(app->ir_learn, ir_learn_match_callback, app);
+    ir_learn_set_import_callback(app->ir_learn, ir_learn_import_callback, app);
+
+    // The first step of a macro always goes out on the deadline, only later ones wait
+    const IrMacro* macro = ir_bank_selected_macro(&app->bank);
+    ir_learn_set_step_delay(
+        app->ir_learn, app->learn_append && macro->count > 0, app->step_delay_ms);
+
+    // A plain LEARN clears the slot first, an appended step only gets its free tail
+    size_t free_timings = IR_BANK_SLOT_TIMINGS;
+    if(app->learn_append) {
+        ir_bank_peek_timings(&app->bank, app->bank.selected, &free_timings);
+    }
+    ir_learn_set_max_timings(app->ir_learn, free_timings);
 
     // Start receiving immediately
     ir_learn_start_receiving(app->ir_learn);
@@ -22,5 +36,6 @@ bool pause_timer_scene_ir_learn_on_event(void* context, SceneManagerEvent event)
 }
 
 void pause_timer_scene_ir_learn_on_exit(void* context) {
-    UNUSED(context);
+    PauseTimerApp* app = context;
+    ir_learn_stop_receiving(app->ir_learn);
 }
@@ -0,0 +1,43 @@
+#include "../pause_timer.h"
+#include "../views.h"
+
+#define TAG "PauseTimer"
+
+void pause_timer_scene_ir_listen_on_enter(void* context) {
+    PauseTimerApp* app = context;
+
+    FURI_LOG_D(TAG, "Starting IR listen scene");
+
+    ir_learn_set_callbacks(app->ir_learn, NULL, ir_learn_back_callback, app);
+    ir_learn_set_trigger_callback(app->ir_learn, ir_learn_trigger_callback, app);
+
+    // Also runs again when the countdown is left, so the next press starts another one
+    ir_learn_start_listening(app->ir_learn, app->trigger_fingerprint);
+
+    view_dispatcher_switch_to_view(app->view_dispatcher, PTViewIrLearn);
+}
+
+bool pause_timer_scene_ir_listen_on_event(void* context, SceneManagerEvent event) {
+    PauseTimerApp* app = context;
+    if(event.type != SceneManagerEventTypeCustom || event.event != PTCustomEventTriggered) {
+        return false;
+    }
+
+    // The countdown scene arms the timer in on_enter, counting from trigger_tick
+    app->current_start_tick = app->trigger_tick;
+    scene_manager_next_scene(app->scene_manager, PauseTimerSceneCountdown);
+
+    uint32_t latency = furi_get_tick() - app->trigger_tick;
+    pt_trace(PtTraceTriggered, app->trigger_fingerprint, latency);
+    FURI_LOG_I(
+        TAG,
+        "Trigger to countdown start: %lu ms",
+        latency * 1000 / furi_kernel_get_tick_frequency());
+    return true;
+}
+
+void pause_timer_scene_ir_listen_on_exit(void* context) {
+    PauseTimerApp* app = context;
+    ir_learn_stop_receiving(app->ir_learn);
+    ir_learn_set_trigger_callback(app->ir_learn, NULL, NULL);
+}
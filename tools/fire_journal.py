@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+"""Print the fire journal (apps_data/pause_timer/fires.bin) copied off the SD card."""
+
+import struct
+import sys
+from datetime import datetime, timezone
+
+HEADER = struct.Struct("<4sBBH")
+RECORD = struct.Struct("<IIIIHBBBB")
+OUTCOMES = ["sent", "missed", "no signal"]
+PINS = {0: "internal", 1: "PA7", 0xFE: "both"}
+
+
+def main(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    magic, version, record_size, tick_hz = HEADER.unpack_from(data, 0)
+    if magic != b"PTFJ" or version != 1 or record_size != RECORD.size:
+        sys.exit(f"{path}: not a version 1 fire journal")
+
+    print("started              cycle slot  sig id    pin       sent  late ms  outcome")
+    for offset in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        (start, deadline, fired, signal_id, cycle, slot, pin, sent, outcome) = RECORD.unpack_from(
+            data, offset
+        )
+        started = datetime.fromtimestamp(start, timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        late_ms = ((fired - deadline + 2**31) % 2**32 - 2**31) * 1000 // tick_hz
+        print(
+            f"{started}  {cycle:5}  {slot + 1:3}  {signal_id:08x}  "
+            f"{PINS.get(pin, pin):8}  {sent:4}  {late_ms:7}  "
+            f"{OUTCOMES[outcome] if outcome < len(OUTCOMES) else outcome}"
+        )
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit(f"usage: {sys.argv[0]} fires.bin")
+    main(sys.argv[1])
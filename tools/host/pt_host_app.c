@@ -0,0 +1,582 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <pt_host.h>
+#include <input/input.h>
+#include <gui/view.h>
+#include <unistd.h>
+#include "../../views.h"
+#include "fire_journal.h"
+#include "ir_bank.h"
+#include "ir_import.h"
+#include "input_replay.h"
+#include "pt_trace.h"
+
+// Generous, the harness waits on the app and the app waits on real timers
+#define WAIT_MS 3000
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        checks++;                                                                 \
+        if(!(condition)) {                                                        \
+            failures++;                                                           \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        }                                                                         \
+    } while(0)
+
+// Polls until condition holds, evaluates to whether it did before the time ran out
+#define WAIT_FOR_MS(condition, ms)                                       \
+    ({                                                                   \
+        uint32_t _start = furi_get_tick();                               \
+        bool _held;                                                      \
+        while(!(_held = (condition)) && furi_get_tick() - _start < (ms)) \
+            furi_delay_ms(1);                                            \
+        _held;                                                           \
+    })
+
+#define WAIT_FOR(condition) WAIT_FOR_MS(condition, WAIT_MS)
+
+int32_t pause_timer_app(void* p);
+
+static const char* corpus_path = NULL;
+static FuriThread* app_thread = NULL;
+static FuriPubSub* input_events = NULL;
+static uint32_t input_sequence = 0;
+static uint32_t input_published = 0;
+
+static const char* const view_names[] = {
+    [PTViewTimeInput] = "time_input",
+    [PTViewCountdown] = "countdown",
+    [PTViewIrLearn] = "ir_learn",
+    [PTViewSubmenu] = "submenu",
+};
+
+static bool app_running(void) {
+    return pt_host_gui_current_view() != VIEW_NONE;
+}
+
+static void app_launch(void) {
+    // The same stack the app gets from application.fam
+    app_thread = furi_thread_alloc_ex("PauseTimer", 2 * 1024, pause_timer_app, NULL);
+    furi_thread_start(app_thread);
+}
+
+static void app_start(void) {
+    app_launch();
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+}
+
+static void app_join(void) {
+    furi_thread_join(app_thread);
+    furi_thread_free(app_thread);
+    app_thread = NULL;
+}
+
+static void publish(InputKey key, InputType type) {
+    InputEvent event = {.sequence = input_sequence, .key = key, .type = type};
+    furi_pubsub_publish(input_events, &event);
+    input_published++;
+}
+
+// A key goes down and up the way the input service reports it, and the call returns once
+// the dispatcher has handled all three events
+static void key(InputKey key, InputType type) {
+    uint32_t handled = pt_host_input_stats()->events;
+    input_sequence++;
+    publish(key, InputTypePress);
+    publish(key, type);
+    publish(key, InputTypeRelease);
+    CHECK(WAIT_FOR(pt_host_input_stats()->events >= handled + 3));
+}
+
+static void key_short(InputKey k) {
+    key(k, InputTypeShort);
+}
+
+// Back on the numpad leaves the app, the dispatcher stops before the Release
+static void app_exit(void) {
+    CHECK(pt_host_gui_current_view() == PTViewTimeInput);
+    input_sequence++;
+    publish(InputKeyBack, InputTypePress);
+    publish(InputKeyBack, InputTypeShort);
+    publish(InputKeyBack, InputTypeRelease);
+    app_join();
+}
+
+// The numpad cursor starts on 7, rows are 789, 456, 123, CLR 0 DEL, START ARM, LEARN S
+static uint8_t cursor_row = 0;
+
+static void numpad_row(uint8_t row) {
+    while(cursor_row != row) {
+        key_short(InputKeyDown);
+        cursor_row = (cursor_row + 1) % 6;
+    }
+}
+
+// Types a single digit from the 1 2 3 row, the time is in MMSS so that many seconds
+static void numpad_seconds(uint8_t seconds) {
+    furi_check(seconds >= 1 && seconds <= 3);
+    numpad_row(3);
+    key_short(InputKeyOk); // CLR
+    numpad_row(2);
+    for(uint8_t i = 1; i < seconds; i++) {
+        key_short(InputKeyRight);
+    }
+    key_short(InputKeyOk);
+    for(uint8_t i = 1; i < seconds; i++) {
+        key_short(InputKeyLeft);
+    }
+}
+
+static size_t transmissions(void) {
+    const PtHostTransmission* log;
+    return pt_host_infrared_transmissions(&log);
+}
+
+static const PtHostTransmission* transmission(size_t index) {
+    const PtHostTransmission* log;
+    furi_check(index < pt_host_infrared_transmissions(&log));
+    return &log[index];
+}
+
+static size_t load_capture(const char* name, uint32_t* timings, size_t capacity) {
+    IrSignalStorage signal = {0};
+    IrImportStatus status = ir_import_signal(NULL, corpus_path, name, timings, capacity, &signal);
+    furi_check(status == IrImportOk && signal.kind == IrSignalKindRaw);
+    return signal.raw.timings_size;
+}
+
+// Opens the learn screen, feeds it one capture and confirms it. A long OK on LEARN appends.
+static void learn(const uint32_t* timings, size_t timings_size, bool append) {
+    numpad_row(5);
+    key(InputKeyOk, append ? InputTypeLong : InputTypeShort);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewIrLearn));
+
+    uint32_t played = pt_host_notification_count_with(&message_vibro_on);
+    CHECK(pt_host_infrared_receive(timings, timings_size));
+    CHECK(WAIT_FOR(pt_host_notification_count_with(&message_vibro_on) > played));
+
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+}
+
+static void learn_capture(const char* name, bool append) {
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+    learn(timings, load_capture(name, timings, COUNT_OF(timings)), append);
+}
+
+static void start_countdown(uint8_t seconds) {
+    numpad_seconds(seconds);
+    numpad_row(4);
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewCountdown));
+}
+
+static size_t read_journal(FireJournalRecord* records, size_t capacity) {
+    FILE* file = fopen(pt_host_storage_path(FIRE_JOURNAL_PATH), "rb");
+    if(!file) return 0;
+    FireJournalHeader header;
+    size_t count = 0;
+    if(fread(&header, sizeof(header), 1, file) == 1 &&
+       memcmp(header.magic, FIRE_JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+       header.record_size == sizeof(FireJournalRecord)) {
+        count = fread(records, sizeof(FireJournalRecord), capacity, file);
+    }
+    fclose(file);
+    return count;
+}
+
+static void reset(void) {
+    pt_host_infrared_reset();
+    pt_host_notification_reset();
+    unlink(pt_host_storage_path(FIRE_JOURNAL_PATH));
+    cursor_row = 0;
+}
+
+// A decoded capture goes out as the protocol, the countdown feedback and journal agree
+static void test_learn_and_fire(void) {
+    reset();
+    app_start();
+    learn_capture("nec_power", false);
+    start_countdown(1);
+
+    CHECK(WAIT_FOR(transmissions() == 1));
+    CHECK(WAIT_FOR(pt_host_notification_count_with(&message_blue_255) == 1));
+    if(transmissions() == 1) {
+        const PtHostTransmission* tx = transmission(0);
+        CHECK(tx->decoded);
+        CHECK(tx->message.protocol == InfraredProtocolNEC);
+        CHECK(tx->message.address == 0x04 && tx->message.command == 0x08);
+        CHECK(tx->pin == FuriHalInfraredTxPinInternal);
+    }
+    CHECK(pt_host_power_otg_enabled() == 0);
+
+    // Any key leaves the finished countdown
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    app_exit();
+
+    // The journal thread flushes on exit
+    FireJournalRecord records[4];
+    CHECK(read_journal(records, COUNT_OF(records)) == 1);
+    CHECK(records[0].sent == 1);
+    CHECK(records[0].outcome == FireJournalOutcomeSent);
+    CHECK(records[0].slot == 0);
+
+#ifdef PT_TRACE
+    // The ring is written out when the app exits
+    CHECK(access(pt_host_storage_path(PT_TRACE_DUMP_PATH), F_OK) == 0);
+#endif
+}
+
+// A raw capture goes out on its own timings and carrier, on the external module when one
+// is plugged in
+static void test_raw_on_external(void) {
+    reset();
+    pt_host_infrared_set_external(true);
+    app_start();
+
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+    size_t size = load_capture("samsung_power", timings, COUNT_OF(timings));
+    learn(timings, size, false);
+    start_countdown(1);
+
+    CHECK(WAIT_FOR(transmissions() == 1));
+    if(transmissions() == 1) {
+        const PtHostTransmission* tx = transmission(0);
+        CHECK(!tx->decoded);
+        CHECK(tx->pin == FuriHalInfraredTxPinExtPA7);
+        CHECK(tx->timings_size == size);
+        CHECK(memcmp(tx->timings, timings, size * sizeof(uint32_t)) == 0);
+        CHECK(tx->frequency >= 36000 && tx->frequency <= 40000);
+    }
+    CHECK(WAIT_FOR(pt_host_power_otg_enabled() == 1));
+
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    app_exit();
+    pt_host_infrared_set_external(false);
+}
+
+// Both steps of a macro go out the step gap apart, and leaving the countdown while the
+// gap runs sends nothing more
+static void test_macro_cancel(void) {
+    reset();
+    app_start();
+    learn_capture("nec_power", false);
+    learn_capture("nec_vol_up", true);
+
+    start_countdown(1);
+    CHECK(WAIT_FOR(transmissions() == 2));
+    if(transmissions() == 2) {
+        uint32_t gap = transmission(1)->tick - transmission(0)->tick;
+        // Offsets count from the deadline, so a late first step shortens the gap
+        CHECK(gap > IR_MACRO_DEFAULT_GAP_MS - 100 && gap < IR_MACRO_DEFAULT_GAP_MS + 100);
+        CHECK(transmission(1)->message.command == 0x02);
+    }
+    CHECK(WAIT_FOR(pt_host_notification_count_with(&message_blue_255) == 1));
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+
+    start_countdown(1);
+    CHECK(WAIT_FOR(transmissions() == 3));
+    key_short(InputKeyBack);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    furi_delay_ms(IR_MACRO_DEFAULT_GAP_MS + 200);
+    CHECK(transmissions() == 3);
+    // A cancelled fire has no fired feedback
+    CHECK(pt_host_notification_count_with(&message_blue_255) == 1);
+    app_exit();
+
+    FireJournalRecord records[4];
+    CHECK(read_journal(records, COUNT_OF(records)) == 2);
+    CHECK(records[0].sent == 2);
+    CHECK(records[1].sent == 1);
+}
+
+// A step that doesn't fit in what is left of the slot is refused with the error feedback
+static void test_append_overflow(void) {
+    reset();
+    app_start();
+
+    // Long enough that two don't fit in one slot, and nothing the decoder takes
+    uint32_t timings[IR_BANK_SLOT_TIMINGS / 2 + 1];
+    for(size_t i = 0; i < COUNT_OF(timings); i++) {
+        timings[i] = i % 2 ? 1500 : 500;
+    }
+    learn(timings, COUNT_OF(timings), false);
+    CHECK(pt_host_notification_count(&sequence_error) == 0);
+
+    numpad_row(5);
+    key(InputKeyOk, InputTypeLong);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewIrLearn));
+    CHECK(pt_host_infrared_receive(timings, COUNT_OF(timings)));
+    CHECK(WAIT_FOR(pt_host_notification_count(&sequence_error) == 1));
+    key_short(InputKeyBack);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+
+    // The slot still holds the first step only
+    start_countdown(1);
+    CHECK(WAIT_FOR(transmissions() == 1));
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    app_exit();
+    CHECK(transmissions() == 1);
+}
+
+// Right on the learn screen imports a button from a file picked in the browser
+static void test_import(void) {
+    reset();
+    app_start();
+    pt_host_dialogs_set_file(corpus_path);
+
+    numpad_row(5);
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewIrLearn));
+    key_short(InputKeyRight);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewSubmenu));
+
+    // The corpus lists nec_power first, the second item is nec_vol_up
+    key_short(InputKeyDown);
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_notification_count(&sequence_success) == 1));
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+
+    start_countdown(1);
+    CHECK(WAIT_FOR(transmissions() == 1));
+    // Imported raw, and upgraded to NEC by the analysis worker before it fired
+    if(transmissions() == 1) {
+        const PtHostTransmission* tx = transmission(0);
+        CHECK(tx->decoded && tx->message.command == 0x02);
+    }
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    app_exit();
+    pt_host_dialogs_set_file(NULL);
+}
+
+static bool read_recording(
+    const char* path,
+    InputReplayHeader* header,
+    InputReplayRecord* records,
+    size_t capacity) {
+    FILE* file = fopen(pt_host_storage_path(path), "rb");
+    if(!file) return false;
+    bool read = fread(header, sizeof(*header), 1, file) == 1 &&
+                header->magic == INPUT_REPLAY_MAGIC && header->version == INPUT_REPLAY_VERSION &&
+                header->count <= capacity &&
+                fread(records, sizeof(InputReplayRecord), header->count, file) == header->count;
+    fclose(file);
+    return read;
+}
+
+// Renames a recording so the next launch plays it back
+static bool use_recording(const char* path) {
+    char from[256];
+    snprintf(from, sizeof(from), "%s", pt_host_storage_path(path));
+    return rename(from, pt_host_storage_path(INPUT_REPLAY_PLAY_PATH)) == 0;
+}
+
+// A session is recorded on exit, and played back it takes the app through the same screens
+// to the same fire and back out
+static void test_replay(void) {
+    reset();
+    app_start();
+    uint32_t published = input_published;
+
+    // Nothing learned, the fire only reaches the journal and the feedback
+    start_countdown(1);
+    CHECK(WAIT_FOR(pt_host_notification_count_with(&message_blue_255) == 1));
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    app_exit();
+    published = input_published - published;
+
+    InputReplayHeader header = {0};
+    static InputReplayRecord records[INPUT_REPLAY_MAX_EVENTS];
+    CHECK(read_recording(INPUT_REPLAY_RECORD_PATH, &header, records, COUNT_OF(records)));
+    // The app can stop listening between the Back that leaves it and the Release
+    CHECK(header.count == published || header.count == published - 1);
+    CHECK(records[0].delta_ms == 0);
+    CHECK(records[0].key == InputKeyDown && records[0].type == InputTypePress);
+    uint32_t duration = 0;
+    for(uint16_t i = 0; i < header.count; i++) {
+        duration += records[i].delta_ms;
+    }
+    CHECK(duration >= 1000);
+
+    CHECK(use_recording(INPUT_REPLAY_RECORD_PATH));
+    reset();
+    uint32_t handled = pt_host_input_stats()->events;
+    app_launch();
+    // Nothing is published from here on, the replay alone gets the app to exit
+    CHECK(WAIT_FOR_MS(
+        pt_host_input_stats()->events >= handled + header.count - 1, duration + WAIT_MS));
+    app_join();
+    CHECK(!app_running());
+
+    FireJournalRecord fires[4];
+    CHECK(read_journal(fires, COUNT_OF(fires)) == 1);
+    CHECK(fires[0].outcome == FireJournalOutcomeNoSignal);
+    CHECK(pt_host_notification_count_with(&message_blue_255) == 1);
+    // A replayed session isn't recorded over the file it plays
+    CHECK(access(pt_host_storage_path(INPUT_REPLAY_RECORD_PATH), F_OK) != 0);
+    unlink(pt_host_storage_path(INPUT_REPLAY_PLAY_PATH));
+}
+
+// Per view draw cost, input handling and timer callbacks of everything run so far
+static void print_stats(void) {
+    printf("view          frames   avg us   max us  allocs/frame\n");
+    for(uint32_t id = 0; id < COUNT_OF(view_names); id++) {
+        const PtHostDrawStats* draw = pt_host_draw_stats(id);
+        if(!draw->frames) continue;
+        printf(
+            "%-12s  %6u  %7.1f  %7.1f  %12.2f\n",
+            view_names[id],
+            draw->frames,
+            draw->total_ns / 1000.0 / draw->frames,
+            draw->max_ns / 1000.0,
+            (double)draw->allocs / draw->frames);
+    }
+
+    const PtHostInputStats* input = pt_host_input_stats();
+    if(input->updates) {
+        printf(
+            "input to model  %u of %u events  avg %.1f us  max %.1f us\n",
+            input->updates,
+            input->events,
+            input->update_total_ns / 1000.0 / input->updates,
+            input->update_max_ns / 1000.0);
+    }
+    if(input->events) {
+        printf(
+            "input handled   %u events  avg %.1f us  max %.1f us\n",
+            input->events,
+            input->handled_total_ns / 1000.0 / input->events,
+            input->handled_max_ns / 1000.0);
+    }
+
+    const PtHostTimerStats* timers;
+    size_t timer_count = pt_host_timer_stats(&timers);
+    for(size_t i = 0; i < timer_count; i++) {
+        if(!timers[i].count) continue;
+        printf(
+            "timer %-30s %4u calls  avg %.1f us  max %.1f us\n",
+            timers[i].name,
+            timers[i].count,
+            timers[i].total_ns / 1000.0 / timers[i].count,
+            timers[i].max_ns / 1000.0);
+    }
+}
+
+// Host numbers only rank changes against each other, the target is a 64 MHz Cortex-M4
+static void bench(void) {
+    reset();
+    app_start();
+    learn_capture("nec_power", false);
+    pt_host_gui_reset_stats();
+
+    // Walk the numpad, then a countdown long enough for a few display ticks
+    for(int i = 0; i < 60; i++) {
+        numpad_row((cursor_row + 1) % 6);
+    }
+    start_countdown(3);
+    CHECK(WAIT_FOR(transmissions() == 1));
+    key_short(InputKeyOk);
+    CHECK(WAIT_FOR(pt_host_gui_current_view() == PTViewTimeInput));
+    learn_capture("nec_vol_up", true);
+    app_exit();
+    print_stats();
+}
+
+// Plays a recording made on a Flipper, or by an earlier run, and prints what it cost
+static bool replay(const char* path) {
+    static struct {
+        InputReplayHeader header;
+        InputReplayRecord records[INPUT_REPLAY_MAX_EVENTS];
+    } FURI_PACKED recording;
+    FILE* source = fopen(path, "rb");
+    if(!source) return false;
+    size_t size = fread(&recording, 1, sizeof(recording), source);
+    fclose(source);
+    if(size < sizeof(recording.header) || recording.header.magic != INPUT_REPLAY_MAGIC) {
+        return false;
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written =
+        storage_file_open(file, INPUT_REPLAY_PLAY_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+        storage_file_write(file, &recording, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    if(!written) return false;
+
+    uint32_t duration = 0;
+    for(uint16_t i = 0; i < MIN(recording.header.count, INPUT_REPLAY_MAX_EVENTS); i++) {
+        duration += recording.records[i].delta_ms;
+    }
+
+    app_launch();
+    WAIT_FOR(app_running());
+    WAIT_FOR_MS(!app_running(), duration + WAIT_MS);
+    // A recording cut off at INPUT_REPLAY_MAX_EVENTS ends inside the app, back out of it
+    while(app_running()) {
+        publish(InputKeyBack, InputTypePress);
+        publish(InputKeyBack, InputTypeShort);
+        publish(InputKeyBack, InputTypeRelease);
+        furi_delay_ms(100);
+    }
+    app_join();
+    print_stats();
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool run_bench = argc == 3 && strcmp(argv[1], "--bench") == 0;
+    const char* replay_path = argc == 4 && strcmp(argv[1], "--replay") == 0 ? argv[2] : NULL;
+    if(argc < 2 || (argc > 2 && !run_bench && !replay_path)) {
+        fprintf(stderr, "usage: %s [--bench | --replay input.rec] corpus.ir\n", argv[0]);
+        return 2;
+    }
+    corpus_path = argv[argc - 1];
+
+    char root[] = "/tmp/pt_host_app_XXXXXX";
+    furi_check(mkdtemp(root));
+    pt_host_services_start(root);
+    input_events = furi_record_open(RECORD_INPUT_EVENTS);
+
+    if(run_bench) {
+        bench();
+    } else if(replay_path) {
+        if(!replay(replay_path)) {
+            fprintf(stderr, "%s: not an input recording\n", replay_path);
+            failures++;
+        }
+    } else {
+        test_learn_and_fire();
+        test_raw_on_external();
+        test_macro_cancel();
+        test_append_overflow();
+        test_import();
+        test_replay();
+        CHECK(!app_running());
+    }
+
+    furi_record_close(RECORD_INPUT_EVENTS);
+    pt_host_services_stop();
+
+    char command[64];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    furi_check(system(command) == 0);
+
+    if(!run_bench && !replay_path) printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,236 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <time.h>
+#include "ir_bank.h"
+#include "ir_fingerprint.h"
+#include "ir_import.h"
+
+// Time spent on each measurement, long enough to average out the clock reads
+#define BENCH_NS     (5 * 1000 * 1000ULL)
+#define BENCH_BATCH  16
+#define MAX_SIGNALS  1024
+#define BENCH_SLOT   0
+#define BENCH_APPEND 1 // Slot the captures are appended to, the way a long LEARN stores them
+
+typedef struct {
+    char name[IR_IMPORT_NAME_LEN];
+    IrImportStatus status;
+    IrSignalStorage signal;
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+    double import_ns;
+    double fingerprint_ns;
+    double store_ns;
+    double find_ns;
+} BenchSignal;
+
+static BenchSignal signals[MAX_SIGNALS];
+static size_t signal_count;
+static bool signals_truncated;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Runs body in batches until BENCH_NS has gone by, evaluates to the ns one run took
+#define BENCH(body)                                            \
+    ({                                                         \
+        uint64_t _start = now_ns(), _elapsed;                  \
+        uint32_t _runs = 0;                                    \
+        do {                                                   \
+            for(int _i = 0; _i < BENCH_BATCH; _i++) {          \
+                body;                                          \
+            }                                                  \
+            _runs += BENCH_BATCH;                              \
+        } while((_elapsed = now_ns() - _start) < BENCH_NS);    \
+        (double)_elapsed / _runs;                              \
+    })
+
+// Universal remote files repeat names, only the first of each can be imported
+static void bench_name_callback(void* context, const char* name) {
+    UNUSED(context);
+    for(size_t i = 0; i < signal_count; i++) {
+        if(strcmp(signals[i].name, name) == 0) return;
+    }
+    if(signal_count == MAX_SIGNALS) {
+        signals_truncated = true;
+        return;
+    }
+    strlcpy(signals[signal_count++].name, name, IR_IMPORT_NAME_LEN);
+}
+
+// The same steps pause_timer_import_signal and the learn screen take to keep a signal
+static bool bench_store(IrBank* bank, uint8_t slot, const IrSignalStorage* signal) {
+    IrMacro* macro = &bank->slots[slot].macro;
+    IrSignalStorage* step = ir_macro_append(macro, 0);
+    if(!step) return false;
+    *step = *signal;
+    if(signal->kind == IrSignalKindRaw) {
+        step->raw.timings = ir_bank_alloc_timings(bank, slot, signal->raw.timings_size);
+        if(!step->raw.timings) {
+            ir_macro_remove_last(macro);
+            return false;
+        }
+        memcpy(
+            step->raw.timings,
+            signal->raw.timings,
+            signal->raw.timings_size * sizeof(uint32_t));
+    }
+    step->fingerprint = ir_fingerprint_signal(step);
+    ir_bank_index_step(bank, slot, macro->count - 1);
+    return true;
+}
+
+static void bench_signal(const char* path, IrBank* bank, BenchSignal* bench) {
+    bench->status = ir_import_signal(
+        NULL, path, bench->name, bench->timings, COUNT_OF(bench->timings), &bench->signal);
+    if(bench->status != IrImportOk) return;
+
+    IrSignalStorage scratch;
+    bench->import_ns = BENCH(ir_import_signal(
+        NULL, path, bench->name, bench->timings, COUNT_OF(bench->timings), &scratch));
+
+    volatile uint32_t sink = 0;
+    bench->fingerprint_ns = BENCH(sink += ir_fingerprint_signal(&bench->signal));
+    bench->signal.fingerprint = ir_fingerprint_signal(&bench->signal);
+
+    // A plain LEARN: the slot is cleared, which rebuilds the index, then the step is stored
+    bench->store_ns = BENCH({
+        ir_bank_clear_slot(bank, BENCH_SLOT);
+        bench_store(bank, BENCH_SLOT, &bench->signal);
+    });
+
+    uint8_t slot, step;
+    bench->find_ns = BENCH(sink += ir_bank_find(bank, bench->signal.fingerprint, &slot, &step));
+    UNUSED(sink);
+}
+
+// Stores the captures in turn, as many as fit in a slot before it is cleared, and counts
+// the stored ones the index finds and the captures it matches to a signal of another name
+static void bench_matches(IrBank* bank, size_t* stored, size_t* found, size_t* collisions) {
+    *stored = *found = *collisions = 0;
+    ir_bank_clear_slot(bank, BENCH_SLOT);
+    ir_bank_clear_slot(bank, BENCH_APPEND);
+
+    size_t owners[IR_MACRO_MAX_STEPS];
+    const IrMacro* macro = &bank->slots[BENCH_APPEND].macro;
+    for(size_t i = 0; i < signal_count; i++) {
+        const BenchSignal* bench = &signals[i];
+        if(bench->status != IrImportOk) continue;
+
+        uint8_t slot, step;
+        if(ir_bank_find(bank, bench->signal.fingerprint, &slot, &step)) {
+            printf("  %s matches %s\n", bench->name, signals[owners[step]].name);
+            (*collisions)++;
+        }
+        if(!bench_store(bank, BENCH_APPEND, &bench->signal)) {
+            ir_bank_clear_slot(bank, BENCH_APPEND);
+            if(!bench_store(bank, BENCH_APPEND, &bench->signal)) continue;
+        }
+        owners[macro->count - 1] = i;
+        (*stored)++;
+        if(ir_bank_find(bank, bench->signal.fingerprint, &slot, &step) && slot == BENCH_APPEND &&
+           owners[step] == i) {
+            (*found)++;
+        }
+    }
+}
+
+static bool bench_file(const char* path, IrBank* bank) {
+    signal_count = 0;
+    signals_truncated = false;
+    if(!ir_import_list(NULL, path, bench_name_callback, NULL)) {
+        fprintf(stderr, "%s: can't read\n", path);
+        return false;
+    }
+
+    printf("%s\n", path);
+    printf(
+        "  %-20s %-7s %7s %10s %12s %10s %9s\n",
+        "signal",
+        "kind",
+        "timings",
+        "import us",
+        "fingerprint",
+        "store ns",
+        "find ns");
+
+    size_t raw = 0, decoded = 0, timings = 0;
+    double import_ns = 0, fingerprint_ns = 0, store_ns = 0, find_ns = 0;
+    for(size_t i = 0; i < signal_count; i++) {
+        BenchSignal* bench = &signals[i];
+        bench_signal(path, bank, bench);
+        if(bench->status != IrImportOk) {
+            printf("  %-20s %s\n", bench->name, ir_import_status_text(bench->status));
+            continue;
+        }
+
+        bool is_raw = bench->signal.kind == IrSignalKindRaw;
+        size_t size = is_raw ? bench->signal.raw.timings_size : 0;
+        printf(
+            "  %-20s %-7s %7zu %10.1f %9.1f ns %10.1f %9.1f\n",
+            bench->name,
+            is_raw ? "raw" : "decoded",
+            size,
+            bench->import_ns / 1000,
+            bench->fingerprint_ns,
+            bench->store_ns,
+            bench->find_ns);
+
+        raw += is_raw;
+        decoded += !is_raw;
+        timings += size;
+        import_ns += bench->import_ns;
+        fingerprint_ns += bench->fingerprint_ns;
+        store_ns += bench->store_ns;
+        find_ns += bench->find_ns;
+    }
+
+    size_t imported = raw + decoded;
+    if(!imported) return true;
+    printf(
+        "  %zu raw, %zu decoded, %zu failed%s, %zu timings (%zu bytes in the bank)\n",
+        raw,
+        decoded,
+        signal_count - imported,
+        signals_truncated ? ", more not read" : "",
+        timings,
+        timings * sizeof(uint32_t));
+    printf(
+        "  average: import %.1f us, fingerprint %.1f ns, store %.1f ns, find %.1f ns\n",
+        import_ns / imported / 1000,
+        fingerprint_ns / imported,
+        store_ns / imported,
+        find_ns / imported);
+
+    size_t stored, found, collisions;
+    bench_matches(bank, &stored, &found, &collisions);
+    printf(
+        "  index: %zu of %zu stored signals found, %zu matched to another name\n",
+        found,
+        stored,
+        collisions);
+    return true;
+}
+
+// Host numbers only rank changes against each other, the target is a 64 MHz Cortex-M4
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s captures.ir...\n", argv[0]);
+        return 2;
+    }
+
+    IrBank bank;
+    ir_bank_init(&bank);
+    int unread = 0;
+    for(int i = 1; i < argc; i++) {
+        if(!bench_file(argv[i], &bank)) unread++;
+    }
+    ir_bank_deinit(&bank);
+    return unread ? 1 : 0;
+}
+
+#endif
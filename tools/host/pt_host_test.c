@@ -0,0 +1,567 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "ir_bank.h"
+#include "ir_carrier.h"
+#include "ir_fingerprint.h"
+#include "ir_import.h"
+#include "ir_macro.h"
+#include "timer_latency.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        checks++;                                                                 \
+        if(!(condition)) {                                                        \
+            failures++;                                                           \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        }                                                                         \
+    } while(0)
+
+static const char* corpus_path = NULL;
+
+// Pulls one raw capture out of the corpus, the corpus is also what the import tests read
+static size_t load_capture(const char* name, uint32_t* timings, size_t capacity) {
+    IrSignalStorage signal = {0};
+    IrImportStatus status = ir_import_signal(NULL, corpus_path, name, timings, capacity, &signal);
+    CHECK(status == IrImportOk);
+    CHECK(signal.kind == IrSignalKindRaw);
+    return status == IrImportOk ? signal.raw.timings_size : 0;
+}
+
+static const char* write_fixture(const char* content) {
+    static char path[] = "/tmp/pt_host_test_XXXXXX";
+    strcpy(path, "/tmp/pt_host_test_XXXXXX");
+    int fd = mkstemp(path);
+    furi_check(fd >= 0);
+    FILE* file = fdopen(fd, "w");
+    fputs(content, file);
+    fclose(file);
+    return path;
+}
+
+static void test_fingerprint_decoded(void) {
+    InfraredMessage power = {.protocol = InfraredProtocolNEC, .address = 0x04, .command = 0x08};
+    InfraredMessage same = power;
+    same.repeat = true;
+    InfraredMessage other_command = power;
+    other_command.command = 0x09;
+    InfraredMessage other_protocol = power;
+    other_protocol.protocol = InfraredProtocolNECext;
+
+    uint32_t fingerprint = ir_fingerprint_decoded(&power);
+    CHECK(fingerprint != IR_FINGERPRINT_NONE);
+    // A held button's repeat frames are the same button
+    CHECK(ir_fingerprint_decoded(&same) == fingerprint);
+    CHECK(ir_fingerprint_decoded(&other_command) != fingerprint);
+    CHECK(ir_fingerprint_decoded(&other_protocol) != fingerprint);
+
+    IrSignalStorage signal = {0};
+    CHECK(ir_fingerprint_signal(&signal) == IR_FINGERPRINT_NONE);
+    ir_signal_set_decoded(&signal, &power);
+    CHECK(ir_fingerprint_signal(&signal) == fingerprint);
+}
+
+static void test_fingerprint_raw(void) {
+    uint32_t power[IR_BANK_SLOT_TIMINGS];
+    uint32_t vol_up[IR_BANK_SLOT_TIMINGS];
+    size_t power_size = load_capture("nec_power", power, COUNT_OF(power));
+    size_t vol_up_size = load_capture("nec_vol_up", vol_up, COUNT_OF(vol_up));
+    if(!power_size || !vol_up_size) return;
+
+    uint32_t fingerprint = ir_fingerprint_raw(power, power_size);
+    CHECK(fingerprint != IR_FINGERPRINT_NONE);
+    CHECK(ir_fingerprint_raw(vol_up, vol_up_size) != fingerprint);
+
+    // Two captures of one button differ by a few percent per edge
+    uint32_t jittered[IR_BANK_SLOT_TIMINGS];
+    for(size_t i = 0; i < power_size; i++) {
+        jittered[i] = power[i] + ((i % 3) ? power[i] / 25 : 0) - ((i % 5) ? 0 : power[i] / 25);
+    }
+    CHECK(ir_fingerprint_raw(jittered, power_size) == fingerprint);
+
+    // Both buttons are one remote, so the address bits they share hash the same
+    size_t shared = 34;
+    CHECK(ir_fingerprint_raw(power, shared) == ir_fingerprint_raw(vol_up, shared));
+
+    // One clipped pulse doesn't rescale the rest of the capture
+    memcpy(jittered, power, power_size * sizeof(uint32_t));
+    jittered[3] = jittered[3] * 4 / 5;
+    CHECK(ir_fingerprint_raw(jittered, power_size) == fingerprint);
+
+    // The trailing gap is when the receiver gave up, not part of the button
+    memcpy(jittered, power, power_size * sizeof(uint32_t));
+    jittered[power_size - 1] *= 3;
+    CHECK(ir_fingerprint_raw(jittered, power_size) == fingerprint);
+
+    // Only the start is hashed, so what follows it doesn't matter
+    uint32_t long_capture[IR_FINGERPRINT_RAW_TIMINGS + 8];
+    for(size_t i = 0; i < COUNT_OF(long_capture); i++) {
+        long_capture[i] = 500 + (i % 2) * 1000;
+    }
+    uint32_t long_fingerprint = ir_fingerprint_raw(long_capture, COUNT_OF(long_capture));
+    long_capture[IR_FINGERPRINT_RAW_TIMINGS + 4] = 9000;
+    CHECK(ir_fingerprint_raw(long_capture, COUNT_OF(long_capture)) == long_fingerprint);
+
+    uint32_t zeros[4] = {0};
+    CHECK(ir_fingerprint_raw(zeros, COUNT_OF(zeros)) != IR_FINGERPRINT_NONE);
+}
+
+static void test_fingerprint_index(void) {
+    IrFingerprintIndex index;
+    ir_fingerprint_index_reset(&index);
+    uint8_t value = 0xFF;
+
+    CHECK(!ir_fingerprint_index_find(&index, 1234, &value));
+    CHECK(!ir_fingerprint_index_add(&index, IR_FINGERPRINT_NONE, 1));
+    CHECK(ir_fingerprint_index_add(&index, 1234, 7));
+    // The first signal added for a fingerprint wins
+    CHECK(!ir_fingerprint_index_add(&index, 1234, 9));
+    CHECK(ir_fingerprint_index_find(&index, 1234, &value) && value == 7);
+
+    // Fingerprints with the same low bits probe past each other and wrap around the end
+    ir_fingerprint_index_reset(&index);
+    for(uint32_t i = 0; i < 8; i++) {
+        CHECK(ir_fingerprint_index_add(&index, (IR_FINGERPRINT_INDEX_SIZE - 2) + i * 0x100, i));
+    }
+    for(uint32_t i = 0; i < 8; i++) {
+        value = 0xFF;
+        CHECK(ir_fingerprint_index_find(&index, (IR_FINGERPRINT_INDEX_SIZE - 2) + i * 0x100, &value));
+        CHECK(value == i);
+    }
+    CHECK(!ir_fingerprint_index_find(&index, (IR_FINGERPRINT_INDEX_SIZE - 2) + 8 * 0x100, NULL));
+
+    // A full index refuses more instead of looping
+    ir_fingerprint_index_reset(&index);
+    for(uint32_t i = 1; i <= IR_FINGERPRINT_INDEX_SIZE; i++) {
+        CHECK(ir_fingerprint_index_add(&index, i, 0));
+    }
+    CHECK(!ir_fingerprint_index_add(&index, IR_FINGERPRINT_INDEX_SIZE + 1, 0));
+    CHECK(!ir_fingerprint_index_find(&index, IR_FINGERPRINT_INDEX_SIZE + 1, NULL));
+}
+
+static void test_carrier(void) {
+    static const struct {
+        const char* name;
+        uint32_t frequency;
+    } expected[] = {
+        {"nec_power", 38000},
+        {"samsung_power", 38000},
+        {"sirc_power", 40000},
+        {"rc5_pause", 36000},
+        // Unknown, but its shortest mark and first mark happen to fit RC6
+        {"unknown_short", 36000},
+    };
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+
+    for(size_t i = 0; i < COUNT_OF(expected); i++) {
+        size_t size = load_capture(expected[i].name, timings, COUNT_OF(timings));
+        IrCarrier carrier = ir_carrier_estimate(timings, size);
+        if(carrier.frequency != expected[i].frequency) {
+            fprintf(stderr, "%s: carrier %u\n", expected[i].name, (unsigned)carrier.frequency);
+        }
+        CHECK(carrier.frequency == expected[i].frequency);
+    }
+
+    // Pulses that fit no family keep the common carrier
+    static const uint32_t unmatched[] = {3000, 3000, 1500, 3000, 1500, 3000, 3000};
+    CHECK(
+        ir_carrier_estimate(unmatched, COUNT_OF(unmatched)).frequency ==
+        INFRARED_COMMON_CARRIER_FREQUENCY);
+
+    IrCarrier fallback = ir_carrier_estimate(timings, 1);
+    CHECK(fallback.frequency == INFRARED_COMMON_CARRIER_FREQUENCY);
+    CHECK(ir_carrier_estimate(NULL, 10).frequency == INFRARED_COMMON_CARRIER_FREQUENCY);
+}
+
+static void test_timer_latency(void) {
+    TimerLatency latency;
+    timer_latency_reset(&latency);
+    CHECK(timer_latency_percentile(&latency, 95) == 0);
+
+    for(int i = 0; i < 90; i++) {
+        timer_latency_add(&latency, 0);
+    }
+    for(int i = 0; i < 8; i++) {
+        timer_latency_add(&latency, 3);
+    }
+    timer_latency_add(&latency, 1000);
+    timer_latency_add(&latency, 5);
+
+    CHECK(latency.count == 100);
+    CHECK(latency.max == 1000);
+    CHECK(latency.buckets[0] == 90);
+    CHECK(latency.buckets[2] == 8);
+    CHECK(latency.buckets[3] == 1);
+    CHECK(latency.buckets[TIMER_LATENCY_BUCKETS - 1] == 1);
+    CHECK(timer_latency_percentile(&latency, 50) == 0);
+    // Bucket upper bounds, erring late
+    CHECK(timer_latency_percentile(&latency, 95) == 3);
+    CHECK(timer_latency_percentile(&latency, 99) == 7);
+    CHECK(timer_latency_percentile(&latency, 100) == 1000);
+
+    // Never above what was actually seen
+    timer_latency_reset(&latency);
+    timer_latency_add(&latency, 5);
+    CHECK(timer_latency_percentile(&latency, 95) == 5);
+}
+
+static void test_macro(void) {
+    IrMacro macro;
+    ir_macro_init(&macro);
+    CHECK(!ir_macro_has_signal(&macro));
+
+    static const uint32_t delays[] = {700, 2000, 500};
+    for(size_t i = 0; i < COUNT_OF(delays); i++) {
+        IrSignalStorage* signal = ir_macro_append(&macro, delays[i]);
+        CHECK(signal != NULL);
+    }
+    CHECK(macro.count == 3);
+    // The first step always goes on the deadline, the rest add up from there
+    CHECK(macro.steps[0].delay_ms == 0);
+    CHECK(macro.steps[0].offset_ms == 0);
+    CHECK(macro.steps[1].offset_ms == 2000);
+    CHECK(macro.steps[2].offset_ms == 2500);
+    CHECK(!ir_macro_has_signal(&macro));
+
+    InfraredMessage message = {.protocol = InfraredProtocolNEC, .command = 1};
+    ir_signal_set_decoded(&macro.steps[1].signal, &message);
+    CHECK(ir_macro_has_signal(&macro));
+
+    ir_macro_remove_last(&macro);
+    CHECK(macro.count == 2);
+    CHECK(ir_macro_append(&macro, 100) != NULL);
+    CHECK(macro.steps[2].offset_ms == 2100);
+
+    while(macro.count < IR_MACRO_MAX_STEPS) {
+        CHECK(ir_macro_append(&macro, 10) != NULL);
+    }
+    CHECK(ir_macro_append(&macro, 10) == NULL);
+    CHECK(macro.count == IR_MACRO_MAX_STEPS);
+
+    ir_macro_clear(&macro);
+    CHECK(macro.count == 0);
+    ir_macro_remove_last(&macro);
+    CHECK(macro.count == 0);
+}
+
+static void test_bank(void) {
+    IrBank bank;
+    ir_bank_init(&bank);
+
+    size_t capacity = 0;
+    uint32_t* tail = ir_bank_peek_timings(&bank, 1, &capacity);
+    CHECK(capacity == IR_BANK_SLOT_TIMINGS);
+    uint32_t* timings = ir_bank_alloc_timings(&bank, 1, 100);
+    CHECK(timings == tail);
+    CHECK(ir_bank_peek_timings(&bank, 1, &capacity) == timings + 100);
+    CHECK(capacity == IR_BANK_SLOT_TIMINGS - 100);
+    // Slots never spill into each other
+    CHECK(ir_bank_alloc_timings(&bank, 1, IR_BANK_SLOT_TIMINGS - 99) == NULL);
+    CHECK(ir_bank_alloc_timings(&bank, 1, IR_BANK_SLOT_TIMINGS - 100) != NULL);
+    CHECK(ir_bank_alloc_timings(&bank, 1, 1) == NULL);
+    CHECK(ir_bank_peek_timings(&bank, 2, &capacity) == bank.pool + 2 * IR_BANK_SLOT_TIMINGS);
+
+    ir_bank_select(&bank, 1);
+    IrSignalStorage* signal = ir_macro_append(ir_bank_selected_macro(&bank), 0);
+    InfraredMessage message = {.protocol = InfraredProtocolSIRC, .address = 1, .command = 21};
+    ir_signal_set_decoded(signal, &message);
+    signal->fingerprint = ir_fingerprint_signal(signal);
+    ir_bank_reindex(&bank);
+
+    uint8_t slot = 0xFF, step = 0xFF;
+    CHECK(ir_bank_find(&bank, signal->fingerprint, &slot, &step));
+    CHECK(slot == 1 && step == 0);
+
+    // Background analysis swaps a raw step for its decoded message, but not once the
+    // step was relearned
+    static uint32_t raw[] = {900, 900, 1800, 900};
+    IrSignalStorage* raw_step = ir_macro_append(ir_bank_selected_macro(&bank), 0);
+    ir_signal_set_raw(raw_step, raw, COUNT_OF(raw), 36000, 0.25f);
+    raw_step->fingerprint = ir_fingerprint_signal(raw_step);
+    uint32_t raw_fingerprint = raw_step->fingerprint;
+    InfraredMessage decoded = {.protocol = InfraredProtocolRC5, .address = 0, .command = 12};
+    uint32_t decoded_fingerprint = ir_fingerprint_decoded(&decoded);
+    CHECK(!ir_bank_upgrade_step(&bank, 1, 1, raw_fingerprint + 1, &decoded, decoded_fingerprint));
+    CHECK(!ir_bank_upgrade_step(&bank, 1, 2, raw_fingerprint, &decoded, decoded_fingerprint));
+    IrMacro copy;
+    ir_bank_copy_macro(&bank, 1, &copy);
+    CHECK(copy.count == 2 && copy.steps[1].signal.kind == IrSignalKindRaw);
+    CHECK(ir_bank_upgrade_step(&bank, 1, 1, raw_fingerprint, &decoded, decoded_fingerprint));
+    CHECK(raw_step->kind == IrSignalKindDecoded && raw_step->fingerprint == decoded_fingerprint);
+    CHECK(!ir_bank_upgrade_step(&bank, 1, 1, raw_fingerprint, &decoded, decoded_fingerprint));
+    ir_bank_copy_macro(&bank, 1, &copy);
+    CHECK(copy.steps[1].signal.kind == IrSignalKindDecoded);
+    CHECK(copy.steps[1].signal.decoded.command == 12);
+
+    ir_bank_clear_slot(&bank, 1);
+    CHECK(!ir_bank_find(&bank, ir_fingerprint_decoded(&message), NULL, NULL));
+    ir_bank_peek_timings(&bank, 1, &capacity);
+    CHECK(capacity == IR_BANK_SLOT_TIMINGS);
+
+    ir_bank_deinit(&bank);
+}
+
+typedef struct {
+    IrBank* bank;
+    uint32_t fingerprint;
+    volatile bool done;
+    int misses;
+} BankLookups;
+
+// What the IR worker does while the GUI thread relearns other slots
+static void* bank_lookup_thread(void* context) {
+    BankLookups* lookups = context;
+    while(!lookups->done) {
+        uint8_t slot = 0xFF, step = 0xFF;
+        bool found = ir_bank_find(lookups->bank, lookups->fingerprint, &slot, &step);
+        if(!found || slot != 0 || step != 0) lookups->misses++;
+    }
+    return NULL;
+}
+
+static void test_bank_concurrent_lookup(void) {
+    IrBank bank;
+    ir_bank_init(&bank);
+
+    InfraredMessage message = {.protocol = InfraredProtocolNEC, .address = 4, .command = 8};
+    IrSignalStorage* signal = ir_macro_append(&bank.slots[0].macro, 0);
+    ir_signal_set_decoded(signal, &message);
+    signal->fingerprint = ir_fingerprint_signal(signal);
+    ir_bank_index_step(&bank, 0, 0);
+
+    BankLookups lookups = {.bank = &bank, .fingerprint = signal->fingerprint};
+    pthread_t thread;
+    pthread_create(&thread, NULL, bank_lookup_thread, &lookups);
+
+    // The stored signal never changes, so every lookup has to find it however the
+    // rebuilds interleave with them
+    InfraredMessage other = {.protocol = InfraredProtocolNECext, .address = 2};
+    for(uint32_t i = 0; i < 20000; i++) {
+        IrMacro* macro = &bank.slots[1 + i % 3].macro;
+        ir_macro_clear(macro);
+        other.command = i;
+        IrSignalStorage* step = ir_macro_append(macro, 0);
+        ir_signal_set_decoded(step, &other);
+        step->fingerprint = ir_fingerprint_signal(step);
+        ir_bank_reindex(&bank);
+    }
+    lookups.done = true;
+    pthread_join(thread, NULL);
+    CHECK(lookups.misses == 0);
+
+    ir_bank_deinit(&bank);
+}
+
+static void count_name(void* context, const char* name) {
+    UNUSED(name);
+    (*(int*)context)++;
+}
+
+static void test_import_corpus(void) {
+    int names = 0;
+    CHECK(ir_import_list(NULL, corpus_path, count_name, &names));
+    CHECK(names == 10);
+
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+    IrSignalStorage signal = {0};
+    CHECK(
+        ir_import_signal(NULL, corpus_path, "ac_cool_24", timings, COUNT_OF(timings), &signal) ==
+        IrImportOk);
+    CHECK(signal.kind == IrSignalKindRaw);
+    CHECK(signal.raw.timings == timings);
+    CHECK(signal.raw.frequency == 38000);
+    CHECK(signal.raw.duty_cycle == 33);
+    CHECK(signal.raw.timings_size == 99);
+
+    // A check only pass counts the same timings without storing them
+    IrSignalStorage counted = {0};
+    CHECK(
+        ir_import_signal(NULL, corpus_path, "ac_cool_24", NULL, COUNT_OF(timings), &counted) ==
+        IrImportOk);
+    CHECK(counted.raw.timings_size == signal.raw.timings_size);
+
+    CHECK(
+        ir_import_signal(NULL, corpus_path, "ac_cool_24", timings, 10, &signal) ==
+        IrImportErrorTooLong);
+    CHECK(
+        ir_import_signal(NULL, corpus_path, "nope", timings, COUNT_OF(timings), &signal) ==
+        IrImportErrorNotFound);
+    CHECK(
+        ir_import_signal(NULL, "/nonexistent.ir", "nope", timings, 10, &signal) ==
+        IrImportErrorOpen);
+}
+
+static const char import_fixture[] =
+    "Filetype: IR signals file\r\n"
+    "Version: 1\r\n"
+    "# A comment with name: in it\r\n"
+    "name: Power\r\n"
+    "type: parsed\r\n"
+    "protocol: NECext\r\n"
+    "address: 04 EE 00 00\r\n"
+    "command: 08 F7 00 00\r\n"
+    "#\r\n"
+    "name: Vol up  \r\n"
+    "type: raw\r\n"
+    "frequency: 36000\r\n"
+    "duty_cycle: 0.250000\r\n"
+    "data: 889 889 1778 889 889 1778 889 889 889 889 889 889 889 889 889 889 889 1778 889\r\n"
+    "#\r\n"
+    "name: Power\r\n"
+    "type: parsed\r\n"
+    "protocol: NEC\r\n"
+    "address: 01 00 00 00\r\n"
+    "command: 02 00 00 00\r\n"
+    "#\r\n"
+    "name: Too fast\r\n"
+    "type: raw\r\n"
+    "frequency: 200000\r\n"
+    "duty_cycle: 0.330000\r\n"
+    "data: 500 500 500\r\n"
+    "#\r\n"
+    "name: Too slow\r\n"
+    "type: raw\r\n"
+    "frequency: 9000\r\n"
+    "duty_cycle: 0.330000\r\n"
+    "data: 500 500 500\r\n"
+    "#\r\n"
+    "name: No duty\r\n"
+    "type: raw\r\n"
+    "frequency: 38000\r\n"
+    "duty_cycle: 0\r\n"
+    "data: 500 500 500\r\n"
+    "#\r\n"
+    "name: Huge duty\r\n"
+    "type: raw\r\n"
+    "frequency: 38000\r\n"
+    "duty_cycle: 3.5\r\n"
+    "data: 500 500 500\r\n"
+    "#\r\n"
+    "name: No data\r\n"
+    "type: raw\r\n"
+    "frequency: 38000\r\n"
+    "duty_cycle: 0.33\r\n"
+    "#\r\n"
+    "name: Bad protocol\r\n"
+    "type: parsed\r\n"
+    "protocol: Morse\r\n"
+    "address: 01 00 00 00\r\n"
+    "command: 02 00 00 00\r\n";
+
+static void test_import_fixture(void) {
+    const char* path = write_fixture(import_fixture);
+    uint32_t timings[64];
+    IrSignalStorage signal = {0};
+
+    // Universal remote files repeat names, the first one counts
+    CHECK(ir_import_signal(NULL, path, "Power", timings, COUNT_OF(timings), &signal) == IrImportOk);
+    CHECK(signal.kind == IrSignalKindDecoded);
+    CHECK(signal.decoded.protocol == InfraredProtocolNECext);
+    CHECK(signal.decoded.address == 0xEE04);
+    CHECK(signal.decoded.command == 0xF708);
+
+    // Trailing spaces and CRLF line ends are not part of the name or the values
+    CHECK(ir_import_signal(NULL, path, "Vol up", timings, COUNT_OF(timings), &signal) == IrImportOk);
+    CHECK(signal.kind == IrSignalKindRaw);
+    CHECK(signal.raw.timings_size == 19);
+    CHECK(signal.raw.frequency == 36000);
+    CHECK(signal.raw.duty_cycle == 25);
+    CHECK(timings[0] == 889 && timings[2] == 1778 && timings[18] == 889);
+
+    // Carriers the transmitter would crash on are refused when importing, not when firing
+    static const char* const refused[] = {
+        "Too fast", "Too slow", "No duty", "Huge duty", "No data", "Bad protocol"};
+    for(size_t i = 0; i < COUNT_OF(refused); i++) {
+        IrImportStatus status =
+            ir_import_signal(NULL, path, refused[i], timings, COUNT_OF(timings), &signal);
+        if(status != IrImportErrorFormat) fprintf(stderr, "%s: status %d\n", refused[i], status);
+        CHECK(status == IrImportErrorFormat);
+    }
+
+    unlink(path);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Host numbers only rank changes against each other, the target is a 64 MHz Cortex-M4
+static void bench(void) {
+    uint32_t timings[IR_BANK_SLOT_TIMINGS];
+    size_t size = load_capture("ac_cool_24", timings, COUNT_OF(timings));
+    const int rounds = 200000;
+    volatile uint32_t sink = 0;
+
+    uint64_t start = now_ns();
+    for(int i = 0; i < rounds; i++) {
+        timings[0] += i & 1;
+        sink += ir_fingerprint_raw(timings, size);
+    }
+    printf("ir_fingerprint_raw  %zu timings  %8.1f ns\n", size, (double)(now_ns() - start) / rounds);
+
+    start = now_ns();
+    for(int i = 0; i < rounds; i++) {
+        timings[0] += i & 1;
+        sink += ir_carrier_estimate(timings, size).frequency;
+    }
+    printf("ir_carrier_estimate %zu timings  %8.1f ns\n", size, (double)(now_ns() - start) / rounds);
+
+    IrFingerprintIndex index;
+    ir_fingerprint_index_reset(&index);
+    for(uint32_t i = 1; i <= IR_FINGERPRINT_INDEX_SIZE / 2; i++) {
+        ir_fingerprint_index_add(&index, i * 2654435761U, i);
+    }
+    start = now_ns();
+    for(int i = 0; i < rounds; i++) {
+        sink += ir_fingerprint_index_find(&index, (i % 64) * 2654435761U, NULL);
+    }
+    printf("index find, half full          %8.1f ns\n", (double)(now_ns() - start) / rounds);
+
+    const int imports = 2000;
+    IrSignalStorage signal;
+    start = now_ns();
+    for(int i = 0; i < imports; i++) {
+        ir_import_signal(NULL, corpus_path, "unknown_short", timings, COUNT_OF(timings), &signal);
+    }
+    printf("import, last of 10 signals     %8.1f us\n", (double)(now_ns() - start) / imports / 1000);
+    UNUSED(sink);
+}
+
+int main(int argc, char** argv) {
+    bool run_bench = argc > 2 && strcmp(argv[1], "--bench") == 0;
+    if(argc < 2 || (argc > 2 && !run_bench)) {
+        fprintf(stderr, "usage: %s [--bench] corpus.ir\n", argv[0]);
+        return 2;
+    }
+    corpus_path = argv[argc - 1];
+
+    if(run_bench) {
+        bench();
+        return 0;
+    }
+
+    test_fingerprint_decoded();
+    test_fingerprint_raw();
+    test_fingerprint_index();
+    test_carrier();
+    test_timer_latency();
+    test_macro();
+    test_bank();
+    test_bank_concurrent_lookup();
+    test_import_corpus();
+    test_import_fixture();
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint8_t weekday;
+} DateTime;
+
+// Timestamps count the RTC's local time as if it were UTC, like the firmware's
+uint32_t datetime_datetime_to_timestamp(DateTime* datetime);
+void datetime_timestamp_to_datetime(uint32_t timestamp, DateTime* datetime);
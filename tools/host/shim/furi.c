@@ -0,0 +1,806 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <pt_host.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// The real allocator and printf underneath the stand-ins
+#undef malloc
+#undef free
+#undef snprintf
+#undef strlcpy
+
+// About what a Flipper has free once a FAP is loaded
+#define PT_HOST_HEAP_SIZE (128 * 1024)
+#define PT_HOST_FORMAT_SIZE 256
+#define PT_HOST_TIMERS 32
+#define PT_HOST_TIMER_NAMES 16
+#define PT_HOST_SUBSCRIBERS 8
+#define PT_HOST_RECORDS 8
+#define PT_HOST_STACK_PAINT 0xA5
+
+static char pt_host_log_level = 'N';
+
+void pt_host_set_log_level(char level) {
+    pt_host_log_level = level;
+}
+
+void pt_host_crash(const char* what, const char* file, int line) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    abort();
+}
+
+// Copies format without the l of %lu, %lX, %ld and so on, %llu stays as it is
+static const char* pt_host_format(const char* format, char* buffer) {
+    size_t out = 0;
+    for(const char* in = format; *in; in++) {
+        if(out >= PT_HOST_FORMAT_SIZE - 2) return format;
+        buffer[out++] = *in;
+        if(*in != '%') continue;
+        in++;
+        while(*in && strchr("-+ #0123456789.*", *in)) {
+            if(out >= PT_HOST_FORMAT_SIZE - 2) return format;
+            buffer[out++] = *in++;
+        }
+        if(in[0] == 'l' && in[1] != 'l') in++;
+        if(!*in) break;
+        buffer[out++] = *in;
+    }
+    buffer[out] = '\0';
+    return buffer;
+}
+
+void pt_host_log(char level, const char* tag, const char* format, ...) {
+    static const char levels[] = "NEWID";
+    if(strchr(levels, level) > strchr(levels, pt_host_log_level)) return;
+
+    char buffer[PT_HOST_FORMAT_SIZE];
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%6lu [%c][%s] ", (unsigned long)furi_get_tick(), level, tag);
+    vfprintf(stderr, pt_host_format(format, buffer), args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+int pt_host_snprintf(char* buffer, size_t size, const char* format, ...) {
+    char fixed[PT_HOST_FORMAT_SIZE];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, size, pt_host_format(format, fixed), args);
+    va_end(args);
+    return length;
+}
+
+size_t pt_host_strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if(size) {
+        size_t copy = MIN(length, size - 1);
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return length;
+}
+
+// Heap
+
+typedef struct {
+    size_t size;
+    size_t padding; // Keeps the block 16 byte aligned like glibc's
+} PtHostBlock;
+
+static size_t pt_host_heap_in_use = 0;
+static __thread uint32_t pt_host_allocs = 0;
+
+void* pt_host_malloc(size_t size) {
+    PtHostBlock* block = calloc(1, sizeof(PtHostBlock) + size);
+    furi_check(block);
+    block->size = size;
+    __atomic_fetch_add(&pt_host_heap_in_use, size, __ATOMIC_RELAXED);
+    pt_host_allocs++;
+    return block + 1;
+}
+
+void pt_host_free(void* ptr) {
+    if(!ptr) return;
+    PtHostBlock* block = (PtHostBlock*)ptr - 1;
+    __atomic_fetch_sub(&pt_host_heap_in_use, block->size, __ATOMIC_RELAXED);
+    free(block);
+}
+
+uint32_t pt_host_thread_allocs(void) {
+    return pt_host_allocs;
+}
+
+size_t pt_host_heap_used(void) {
+    return __atomic_load_n(&pt_host_heap_in_use, __ATOMIC_RELAXED);
+}
+
+size_t memmgr_get_free_heap(void) {
+    size_t used = pt_host_heap_used();
+    return used < PT_HOST_HEAP_SIZE ? PT_HOST_HEAP_SIZE - used : 0;
+}
+
+size_t memmgr_heap_get_max_free_block(void) {
+    return memmgr_get_free_heap();
+}
+
+// Kernel
+
+uint64_t pt_host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Set before main, so every thread counts ticks from the same moment
+static uint64_t pt_host_boot_ns = 0;
+
+__attribute__((constructor)) static void pt_host_boot(void) {
+    pt_host_boot_ns = pt_host_now_ns();
+    const char* level = getenv("PT_HOST_LOG");
+    if(level) pt_host_set_log_level(level[0]);
+}
+
+uint32_t furi_get_tick(void) {
+    return (pt_host_now_ns() - pt_host_boot_ns) / 1000000;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+void furi_delay_tick(uint32_t ticks) {
+    struct timespec ts = {.tv_sec = ticks / 1000, .tv_nsec = (ticks % 1000) * 1000000L};
+    while(nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    furi_delay_tick(milliseconds);
+}
+
+static void pt_host_cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec pt_host_deadline(uint64_t deadline_ns) {
+    return (struct timespec){
+        .tv_sec = deadline_ns / 1000000000ULL,
+        .tv_nsec = deadline_ns % 1000000000ULL,
+    };
+}
+
+// Waits on cond until ready is set, the timeout runs out or forever, with mutex held
+static bool pt_host_wait(
+    pthread_cond_t* cond,
+    pthread_mutex_t* mutex,
+    const volatile bool* ready,
+    uint32_t timeout) {
+    uint64_t deadline = pt_host_now_ns() + (uint64_t)timeout * 1000000ULL;
+    struct timespec ts = pt_host_deadline(deadline);
+    while(!*ready) {
+        if(timeout == 0) return false;
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(cond, mutex);
+        } else if(pthread_cond_timedwait(cond, mutex, &ts) == ETIMEDOUT) {
+            return *ready;
+        }
+    }
+    return true;
+}
+
+// Mutex
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = pt_host_malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if(type == FuriMutexTypeRecursive) {
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    }
+    pthread_mutex_init(&mutex->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->mutex);
+    pt_host_free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(timeout == FuriWaitForever) {
+        return pthread_mutex_lock(&mutex->mutex) ? FuriStatusError : FuriStatusOk;
+    }
+    if(timeout == 0) {
+        return pthread_mutex_trylock(&mutex->mutex) ? FuriStatusErrorTimeout : FuriStatusOk;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t deadline = ts.tv_sec * 1000000000ULL + ts.tv_nsec + timeout * 1000000ULL;
+    ts = pt_host_deadline(deadline);
+    return pthread_mutex_timedlock(&mutex->mutex, &ts) ? FuriStatusErrorTimeout : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    return pthread_mutex_unlock(&mutex->mutex) ? FuriStatusError : FuriStatusOk;
+}
+
+// Semaphore
+
+struct FuriSemaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+    volatile bool available;
+};
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    furi_check(max_count && initial_count <= max_count);
+    FuriSemaphore* semaphore = pt_host_malloc(sizeof(FuriSemaphore));
+    pthread_mutex_init(&semaphore->mutex, NULL);
+    pt_host_cond_init(&semaphore->cond);
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    semaphore->available = initial_count > 0;
+    return semaphore;
+}
+
+void furi_semaphore_free(FuriSemaphore* semaphore) {
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+    pt_host_free(semaphore);
+}
+
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout) {
+    pthread_mutex_lock(&semaphore->mutex);
+    bool taken = pt_host_wait(&semaphore->cond, &semaphore->mutex, &semaphore->available, timeout);
+    if(taken) {
+        semaphore->count--;
+        semaphore->available = semaphore->count > 0;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+    return taken ? FuriStatusOk : (timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource);
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore) {
+    FuriStatus status = FuriStatusOk;
+    pthread_mutex_lock(&semaphore->mutex);
+    if(semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        semaphore->available = true;
+        pthread_cond_signal(&semaphore->cond);
+    } else {
+        status = FuriStatusErrorResource;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+    return status;
+}
+
+// Message queue
+
+struct FuriMessageQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    uint8_t* buffer;
+    uint32_t msg_count;
+    uint32_t msg_size;
+    uint32_t head;
+    uint32_t count;
+    volatile bool not_empty;
+    volatile bool not_full;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* queue = pt_host_malloc(sizeof(FuriMessageQueue));
+    pthread_mutex_init(&queue->mutex, NULL);
+    pt_host_cond_init(&queue->changed);
+    queue->buffer = pt_host_malloc(msg_count * msg_size);
+    queue->msg_count = msg_count;
+    queue->msg_size = msg_size;
+    queue->head = 0;
+    queue->count = 0;
+    queue->not_empty = false;
+    queue->not_full = true;
+    return queue;
+}
+
+void furi_message_queue_free(FuriMessageQueue* queue) {
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->mutex);
+    pt_host_free(queue->buffer);
+    pt_host_free(queue);
+}
+
+static void pt_host_queue_update(FuriMessageQueue* queue) {
+    queue->not_empty = queue->count > 0;
+    queue->not_full = queue->count < queue->msg_count;
+    pthread_cond_broadcast(&queue->changed);
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&queue->mutex);
+    bool room = pt_host_wait(&queue->changed, &queue->mutex, &queue->not_full, timeout);
+    if(room) {
+        uint32_t tail = (queue->head + queue->count) % queue->msg_count;
+        memcpy(queue->buffer + tail * queue->msg_size, msg, queue->msg_size);
+        queue->count++;
+        pt_host_queue_update(queue);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return room ? FuriStatusOk : (timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource);
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&queue->mutex);
+    bool got = pt_host_wait(&queue->changed, &queue->mutex, &queue->not_empty, timeout);
+    if(got) {
+        memcpy(msg, queue->buffer + queue->head * queue->msg_size, queue->msg_size);
+        queue->head = (queue->head + 1) % queue->msg_count;
+        queue->count--;
+        pt_host_queue_update(queue);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return got ? FuriStatusOk : (timeout ? FuriStatusErrorTimeout : FuriStatusErrorResource);
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    uint32_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+// Thread
+
+struct FuriThread {
+    const char* name;
+    uint32_t stack_size;
+    FuriThreadCallback callback;
+    void* context;
+    pthread_t thread;
+    uint8_t* stack;
+    size_t host_stack_size;
+    bool started;
+    int32_t ret;
+};
+
+static __thread FuriThread* pt_host_current_thread = NULL;
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    FuriThread* thread = pt_host_malloc(sizeof(FuriThread));
+    thread->name = name;
+    thread->stack_size = stack_size;
+    thread->callback = callback;
+    thread->context = context;
+    thread->stack = NULL;
+    thread->started = false;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    furi_check(!thread->started);
+    free(thread->stack);
+    pt_host_free(thread);
+}
+
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority) {
+    UNUSED(thread);
+    UNUSED(priority);
+}
+
+static void* pt_host_thread_body(void* context) {
+    FuriThread* thread = context;
+    pt_host_current_thread = thread;
+    thread->ret = thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_check(!thread->started);
+    long page = sysconf(_SC_PAGESIZE);
+    thread->host_stack_size = (thread->stack_size + PT_HOST_STACK_EXTRA + page - 1) / page * page;
+    if(!thread->stack) {
+        furi_check(posix_memalign((void**)&thread->stack, page, thread->host_stack_size) == 0);
+    }
+    memset(thread->stack, PT_HOST_STACK_PAINT, thread->host_stack_size);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, thread->stack, thread->host_stack_size);
+    thread->started = true;
+    furi_check(pthread_create(&thread->thread, &attr, pt_host_thread_body, thread) == 0);
+    pthread_attr_destroy(&attr);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    furi_check(pthread_self() != thread->thread);
+    if(thread->started) {
+        pthread_join(thread->thread, NULL);
+        thread->started = false;
+    }
+    return true;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    return pt_host_current_thread;
+}
+
+const char* furi_thread_get_name(FuriThreadId thread_id) {
+    FuriThread* thread = thread_id;
+    return thread ? thread->name : NULL;
+}
+
+// The stack grows down, so whatever is still painted at the bottom was never reached
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    FuriThread* thread = thread_id;
+    if(!thread || !thread->stack) return 0;
+    size_t untouched = 0;
+    while(untouched < thread->host_stack_size &&
+          thread->stack[untouched] == PT_HOST_STACK_PAINT) {
+        untouched++;
+    }
+    return untouched;
+}
+
+// Timer
+
+struct FuriTimer {
+    FuriTimerCallback callback;
+    void* context;
+    FuriTimerType type;
+    uint32_t period;
+    bool armed;
+    uint64_t expiry_ns;
+    PtHostTimerStats* stats;
+};
+
+static pthread_mutex_t pt_host_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pt_host_timer_changed;
+static FuriTimer* pt_host_timers[PT_HOST_TIMERS];
+static FuriTimer* pt_host_timer_running = NULL;
+static FuriThread* pt_host_timer_thread = NULL;
+static PtHostTimerStats pt_host_timer_names[PT_HOST_TIMER_NAMES];
+static size_t pt_host_timer_name_count = 0;
+
+static FuriTimer* pt_host_timer_next(void) {
+    FuriTimer* next = NULL;
+    for(size_t i = 0; i < PT_HOST_TIMERS; i++) {
+        FuriTimer* timer = pt_host_timers[i];
+        if(timer && timer->armed && (!next || timer->expiry_ns < next->expiry_ns)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+static int32_t pt_host_timer_service(void* context) {
+    UNUSED(context);
+    pthread_mutex_lock(&pt_host_timer_mutex);
+    while(true) {
+        FuriTimer* timer = pt_host_timer_next();
+        if(!timer) {
+            pthread_cond_wait(&pt_host_timer_changed, &pt_host_timer_mutex);
+            continue;
+        }
+        if(timer->expiry_ns > pt_host_now_ns()) {
+            struct timespec ts = pt_host_deadline(timer->expiry_ns);
+            pthread_cond_timedwait(&pt_host_timer_changed, &pt_host_timer_mutex, &ts);
+            continue;
+        }
+
+        if(timer->type == FuriTimerTypePeriodic) {
+            timer->expiry_ns += timer->period * 1000000ULL;
+        } else {
+            timer->armed = false;
+        }
+        pt_host_timer_running = timer;
+        FuriTimerCallback callback = timer->callback;
+        void* callback_context = timer->context;
+        PtHostTimerStats* stats = timer->stats;
+        pthread_mutex_unlock(&pt_host_timer_mutex);
+
+        uint64_t start = pt_host_now_ns();
+        callback(callback_context);
+        uint64_t took = pt_host_now_ns() - start;
+
+        pthread_mutex_lock(&pt_host_timer_mutex);
+        stats->count++;
+        stats->total_ns += took;
+        stats->max_ns = MAX(stats->max_ns, took);
+        pt_host_timer_running = NULL;
+        pthread_cond_broadcast(&pt_host_timer_changed);
+    }
+    return 0;
+}
+
+static void pt_host_timer_service_start(void) {
+    pt_host_cond_init(&pt_host_timer_changed);
+    pt_host_timer_thread = furi_thread_alloc_ex("TimerSvc", 2048, pt_host_timer_service, NULL);
+    furi_thread_start(pt_host_timer_thread);
+}
+
+FuriTimer* pt_host_timer_alloc(
+    FuriTimerCallback callback,
+    FuriTimerType type,
+    void* context,
+    const char* name) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, pt_host_timer_service_start);
+
+    FuriTimer* timer = pt_host_malloc(sizeof(FuriTimer));
+    timer->callback = callback;
+    timer->context = context;
+    timer->type = type;
+    timer->armed = false;
+
+    pthread_mutex_lock(&pt_host_timer_mutex);
+    timer->stats = NULL;
+    for(size_t i = 0; i < pt_host_timer_name_count; i++) {
+        if(strcmp(pt_host_timer_names[i].name, name) == 0) timer->stats = &pt_host_timer_names[i];
+    }
+    if(!timer->stats) {
+        furi_check(pt_host_timer_name_count < PT_HOST_TIMER_NAMES);
+        timer->stats = &pt_host_timer_names[pt_host_timer_name_count++];
+        timer->stats->name = name;
+    }
+    size_t slot = 0;
+    while(slot < PT_HOST_TIMERS && pt_host_timers[slot]) slot++;
+    furi_check(slot < PT_HOST_TIMERS);
+    pt_host_timers[slot] = timer;
+    pthread_mutex_unlock(&pt_host_timer_mutex);
+    return timer;
+}
+
+// On the device the timer service outranks every app thread, so a callback is never
+// left half run once stop returns. Here the caller waits for it instead.
+static void pt_host_timer_disarm(FuriTimer* timer) {
+    timer->armed = false;
+    pthread_cond_broadcast(&pt_host_timer_changed);
+    if(furi_thread_get_current_id() == pt_host_timer_thread) return;
+    while(pt_host_timer_running == timer) {
+        pthread_cond_wait(&pt_host_timer_changed, &pt_host_timer_mutex);
+    }
+}
+
+void furi_timer_free(FuriTimer* timer) {
+    pthread_mutex_lock(&pt_host_timer_mutex);
+    pt_host_timer_disarm(timer);
+    for(size_t i = 0; i < PT_HOST_TIMERS; i++) {
+        if(pt_host_timers[i] == timer) pt_host_timers[i] = NULL;
+    }
+    pthread_mutex_unlock(&pt_host_timer_mutex);
+    pt_host_free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    furi_check(ticks > 0);
+    pthread_mutex_lock(&pt_host_timer_mutex);
+    timer->period = ticks;
+    timer->expiry_ns = pt_host_now_ns() + ticks * 1000000ULL;
+    timer->armed = true;
+    pthread_cond_broadcast(&pt_host_timer_changed);
+    pthread_mutex_unlock(&pt_host_timer_mutex);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    pthread_mutex_lock(&pt_host_timer_mutex);
+    pt_host_timer_disarm(timer);
+    pthread_mutex_unlock(&pt_host_timer_mutex);
+    return FuriStatusOk;
+}
+
+size_t pt_host_timer_stats(const PtHostTimerStats** stats) {
+    *stats = pt_host_timer_names;
+    return pt_host_timer_name_count;
+}
+
+// PubSub, callbacks run on the publishing thread with the list locked like on the device
+
+struct FuriPubSubSubscription {
+    FuriPubSubCallback callback;
+    void* context;
+};
+
+struct FuriPubSub {
+    pthread_mutex_t mutex;
+    FuriPubSubSubscription subscriptions[PT_HOST_SUBSCRIBERS];
+};
+
+FuriPubSub* furi_pubsub_alloc(void) {
+    FuriPubSub* pubsub = pt_host_malloc(sizeof(FuriPubSub));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&pubsub->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return pubsub;
+}
+
+void furi_pubsub_free(FuriPubSub* pubsub) {
+    pthread_mutex_destroy(&pubsub->mutex);
+    pt_host_free(pubsub);
+}
+
+FuriPubSubSubscription*
+    furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* context) {
+    FuriPubSubSubscription* subscription = NULL;
+    pthread_mutex_lock(&pubsub->mutex);
+    for(size_t i = 0; i < PT_HOST_SUBSCRIBERS && !subscription; i++) {
+        if(!pubsub->subscriptions[i].callback) subscription = &pubsub->subscriptions[i];
+    }
+    furi_check(subscription);
+    subscription->callback = callback;
+    subscription->context = context;
+    pthread_mutex_unlock(&pubsub->mutex);
+    return subscription;
+}
+
+void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* subscription) {
+    pthread_mutex_lock(&pubsub->mutex);
+    subscription->callback = NULL;
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+void furi_pubsub_publish(FuriPubSub* pubsub, void* message) {
+    pthread_mutex_lock(&pubsub->mutex);
+    for(size_t i = 0; i < PT_HOST_SUBSCRIBERS; i++) {
+        FuriPubSubSubscription* subscription = &pubsub->subscriptions[i];
+        if(subscription->callback) subscription->callback(message, subscription->context);
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+// Records
+
+typedef struct {
+    const char* name;
+    void* data;
+} PtHostRecord;
+
+static PtHostRecord pt_host_records[PT_HOST_RECORDS];
+
+// Creating a record with NULL data removes it, pt_host_services_stop does that
+void furi_record_create(const char* name, void* data) {
+    PtHostRecord* free_slot = NULL;
+    for(size_t i = 0; i < PT_HOST_RECORDS; i++) {
+        PtHostRecord* record = &pt_host_records[i];
+        if(record->name && strcmp(record->name, name) == 0) {
+            *record = (PtHostRecord){.name = data ? name : NULL, .data = data};
+            return;
+        }
+        if(!record->name && !free_slot) free_slot = record;
+    }
+    if(!data) return;
+    furi_check(free_slot);
+    *free_slot = (PtHostRecord){.name = name, .data = data};
+}
+
+void* furi_record_open(const char* name) {
+    for(size_t i = 0; i < PT_HOST_RECORDS; i++) {
+        if(pt_host_records[i].name && strcmp(pt_host_records[i].name, name) == 0) {
+            return pt_host_records[i].data;
+        }
+    }
+    fprintf(stderr, "record %s was never created\n", name);
+    abort();
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+// String
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void pt_host_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 <= string->capacity) return;
+    size_t capacity = MAX(size + 1, string->capacity * 2);
+    char* data = pt_host_malloc(capacity);
+    memcpy(data, string->data, string->size + 1);
+    pt_host_free(string->data);
+    string->data = data;
+    string->capacity = capacity;
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = pt_host_malloc(sizeof(FuriString));
+    string->capacity = 16;
+    string->data = pt_host_malloc(string->capacity);
+    string->size = 0;
+    return string;
+}
+
+FuriString* furi_string_alloc_set(const char* source) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set(string, source);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    pt_host_free(string->data);
+    pt_host_free(string);
+}
+
+void furi_string_set(FuriString* string, const char* source) {
+    size_t size = strlen(source);
+    pt_host_string_reserve(string, size);
+    memmove(string->data, source, size + 1);
+    string->size = size;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+void furi_string_push_back(FuriString* string, char c) {
+    pt_host_string_reserve(string, string->size + 1);
+    string->data[string->size++] = c;
+    string->data[string->size] = '\0';
+}
+
+static int pt_host_string_vcat(FuriString* string, const char* format, va_list args) {
+    char fixed[PT_HOST_FORMAT_SIZE];
+    format = pt_host_format(format, fixed);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if(length < 0) return length;
+    pt_host_string_reserve(string, string->size + length);
+    vsnprintf(string->data + string->size, length + 1, format, args);
+    string->size += length;
+    return length;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    string->size = 0;
+    string->data[0] = '\0';
+    va_list args;
+    va_start(args, format);
+    int length = pt_host_string_vcat(string, format, args);
+    va_end(args);
+    return length;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = pt_host_string_vcat(string, format, args);
+    va_end(args);
+    return length;
+}
+
+#endif
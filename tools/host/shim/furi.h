@@ -0,0 +1,199 @@
+#pragma once
+
+// The parts of the furi core the app uses, so every source file builds and runs on a Linux
+// host. Kernel objects are pthreads underneath, see furi.c, and a tick is a millisecond.
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef MAX
+#define MAX(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a > _b ? _a : _b;      \
+    })
+#endif
+
+#ifndef MIN
+#define MIN(a, b)               \
+    ({                          \
+        __typeof__(a) _a = (a); \
+        __typeof__(b) _b = (b); \
+        _a < _b ? _a : _b;      \
+    })
+#endif
+
+#define COUNT_OF(x)  (sizeof(x) / sizeof(x[0]))
+#define UNUSED(x)    (void)(x)
+#define FURI_PACKED  __attribute__((packed))
+
+#define EXT_PATH(path)      "/ext/" path
+#define APP_DATA_PATH(path) "/ext/apps_data/pause_timer/" path
+
+void pt_host_crash(const char* what, const char* file, int line);
+
+#define furi_check(x)                                   \
+    do {                                                \
+        if(!(x)) pt_host_crash(#x, __FILE__, __LINE__); \
+    } while(0)
+#define furi_assert(x) furi_check(x)
+
+// The firmware formats are written for a 32 bit target where long is uint32_t. These
+// print them on a 64 bit host by dropping the l from %lu and friends first.
+void pt_host_log(char level, const char* tag, const char* format, ...);
+int pt_host_snprintf(char* buffer, size_t size, const char* format, ...);
+size_t pt_host_strlcpy(char* dst, const char* src, size_t size);
+
+#define FURI_LOG_E(tag, ...) pt_host_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) pt_host_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) pt_host_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) pt_host_log('D', tag, __VA_ARGS__)
+
+#define snprintf pt_host_snprintf
+#define strlcpy  pt_host_strlcpy
+
+// Counted, and zeroed like the firmware's heap does, so the free heap is meaningful
+void* pt_host_malloc(size_t size);
+void pt_host_free(void* ptr);
+
+#define malloc(size) pt_host_malloc(size)
+#define free(ptr)    pt_host_free(ptr)
+
+size_t memmgr_get_free_heap(void);
+size_t memmgr_heap_get_max_free_block(void);
+
+// Kernel
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+} FuriStatus;
+
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+void furi_delay_tick(uint32_t ticks);
+void furi_delay_ms(uint32_t milliseconds);
+
+// Mutex and semaphore
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef struct FuriMutex FuriMutex;
+typedef struct FuriSemaphore FuriSemaphore;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count);
+void furi_semaphore_free(FuriSemaphore* semaphore);
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout);
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore);
+
+// Message queue
+
+typedef struct FuriMessageQueue FuriMessageQueue;
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* queue);
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout);
+uint32_t furi_message_queue_get_count(FuriMessageQueue* queue);
+
+// Thread, priorities are accepted and ignored
+
+typedef enum {
+    FuriThreadPriorityNone = 0,
+    FuriThreadPriorityIdle = 1,
+    FuriThreadPriorityLowest = 14,
+    FuriThreadPriorityLow = 15,
+    FuriThreadPriorityNormal = 16,
+    FuriThreadPriorityHigh = 17,
+    FuriThreadPriorityHighest = 18,
+    FuriThreadPriorityIsr = 32,
+} FuriThreadPriority;
+
+typedef struct FuriThread FuriThread;
+typedef void* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_current_id(void);
+const char* furi_thread_get_name(FuriThreadId thread_id);
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id);
+
+// Timer, every callback runs on one timer service thread like on the device
+
+typedef enum {
+    FuriTimerTypeOnce = 0,
+    FuriTimerTypePeriodic = 1,
+} FuriTimerType;
+
+typedef struct FuriTimer FuriTimer;
+typedef void (*FuriTimerCallback)(void* context);
+
+// The callback's name is kept for the timer benchmark
+FuriTimer* pt_host_timer_alloc(
+    FuriTimerCallback callback,
+    FuriTimerType type,
+    void* context,
+    const char* name);
+#define furi_timer_alloc(callback, type, context) \
+    pt_host_timer_alloc(callback, type, context, #callback)
+void furi_timer_free(FuriTimer* timer);
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* timer);
+
+// PubSub and records
+
+typedef struct FuriPubSub FuriPubSub;
+typedef struct FuriPubSubSubscription FuriPubSubSubscription;
+typedef void (*FuriPubSubCallback)(const void* message, void* context);
+
+FuriPubSub* furi_pubsub_alloc(void);
+void furi_pubsub_free(FuriPubSub* pubsub);
+FuriPubSubSubscription*
+    furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* context);
+void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* subscription);
+void furi_pubsub_publish(FuriPubSub* pubsub, void* message);
+
+void furi_record_create(const char* name, void* data);
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+// String
+
+typedef struct FuriString FuriString;
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_set(const char* source);
+void furi_string_free(FuriString* string);
+void furi_string_set(FuriString* string, const char* source);
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+void furi_string_push_back(FuriString* string, char c);
+int furi_string_printf(FuriString* string, const char* format, ...);
+int furi_string_cat_printf(FuriString* string, const char* format, ...);
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <furi_hal_cortex.h>
+#include <furi_hal_infrared.h>
+#include <furi_hal_power.h>
+#include <furi_hal_rtc.h>
@@ -0,0 +1,15 @@
+#pragma once
+
+// The cycle counter runs off the host's monotonic clock at the Flipper's 64 MHz, so cycle
+// counts turn into the same microseconds the firmware code computes
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} PtHostDwt;
+
+PtHostDwt* pt_host_dwt(void);
+#define DWT (pt_host_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
@@ -0,0 +1,30 @@
+#pragma once
+
+// The asynchronous transmitter calls the data callback until it says LastDone, and what it
+// handed out is logged as one transmission, see pt_host_infrared_transmissions
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    FuriHalInfraredTxPinInternal,
+    FuriHalInfraredTxPinExtPA7,
+    FuriHalInfraredTxPinMax,
+} FuriHalInfraredTxPin;
+
+typedef enum {
+    FuriHalInfraredTxGetDataStateOk,
+    FuriHalInfraredTxGetDataStateDone,
+    FuriHalInfraredTxGetDataStateLastDone,
+} FuriHalInfraredTxGetDataState;
+
+typedef FuriHalInfraredTxGetDataState (
+    *FuriHalInfraredTxGetDataISRCallback)(void* context, uint32_t* duration, bool* level);
+
+FuriHalInfraredTxPin furi_hal_infrared_detect_tx_output(void);
+void furi_hal_infrared_set_tx_output(FuriHalInfraredTxPin tx_pin);
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context);
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle);
+void furi_hal_infrared_async_tx_wait_termination(void);
@@ -0,0 +1,6 @@
+#pragma once
+
+// 5V on the GPIO header for an external IR module, only counted
+
+void furi_hal_power_enable_otg(void);
+void furi_hal_power_disable_otg(void);
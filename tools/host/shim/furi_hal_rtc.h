@@ -0,0 +1,8 @@
+#pragma once
+
+// The RTC reads the host's local time
+
+#include <datetime/datetime.h>
+
+void furi_hal_rtc_get_datetime(DateTime* datetime);
+uint32_t furi_hal_rtc_get_timestamp(void);
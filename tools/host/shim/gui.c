@@ -0,0 +1,863 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <pt_host.h>
+#include <gui/gui.h>
+#include <gui/elements.h>
+#include <gui/view_dispatcher.h>
+#include <gui/scene_manager.h>
+#include <gui/modules/submenu.h>
+#include <pthread.h>
+
+#define PT_HOST_CANVAS_WIDTH  128
+#define PT_HOST_CANVAS_HEIGHT 64
+#define PT_HOST_DISPATCHER_QUEUE 32
+#define PT_HOST_SCENE_DEPTH 16
+#define PT_HOST_SUBMENU_ITEMS 32
+#define PT_HOST_SUBMENU_LABEL 32
+#define PT_HOST_SUBMENU_ROWS 4
+
+// Canvas
+
+typedef struct {
+    uint8_t advance;
+    uint8_t height; // Above the baseline
+} PtHostFont;
+
+// Close to the firmware fonts: helvB08, haxrcorp 4089, profont11 and profont22
+static const PtHostFont pt_host_fonts[FontTotalNumber] = {
+    [FontPrimary] = {.advance = 6, .height = 8},
+    [FontSecondary] = {.advance = 5, .height = 7},
+    [FontKeyboard] = {.advance = 6, .height = 8},
+    [FontBigNumbers] = {.advance = 11, .height = 15},
+};
+
+struct Canvas {
+    uint8_t pixels[PT_HOST_CANVAS_HEIGHT][PT_HOST_CANVAS_WIDTH];
+    Font font;
+    Color color;
+};
+
+static void pt_host_canvas_reset(Canvas* canvas) {
+    memset(canvas->pixels, 0, sizeof(canvas->pixels));
+    canvas->font = FontSecondary;
+    canvas->color = ColorBlack;
+}
+
+void canvas_clear(Canvas* canvas) {
+    memset(canvas->pixels, 0, sizeof(canvas->pixels));
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    furi_check(font < FontTotalNumber);
+    canvas->font = font;
+}
+
+size_t canvas_width(const Canvas* canvas) {
+    UNUSED(canvas);
+    return PT_HOST_CANVAS_WIDTH;
+}
+
+size_t canvas_height(const Canvas* canvas) {
+    UNUSED(canvas);
+    return PT_HOST_CANVAS_HEIGHT;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= PT_HOST_CANVAS_WIDTH || y >= PT_HOST_CANVAS_HEIGHT) return;
+    uint8_t* pixel = &canvas->pixels[y][x];
+    if(canvas->color == ColorXOR) {
+        *pixel ^= 1;
+    } else {
+        *pixel = canvas->color == ColorBlack;
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    for(size_t row = 0; row < height; row++) {
+        for(size_t column = 0; column < width; column++) {
+            canvas_draw_dot(canvas, x + column, y + row);
+        }
+    }
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    if(!width || !height) return;
+    canvas_draw_box(canvas, x, y, width, 1);
+    canvas_draw_box(canvas, x, y + height - 1, width, 1);
+    canvas_draw_box(canvas, x, y, 1, height);
+    canvas_draw_box(canvas, x + width - 1, y, 1, height);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    return strlen(str) * pt_host_fonts[canvas->font].advance;
+}
+
+// y is the baseline, every glyph but a space is a box one pixel narrower than its advance
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    const PtHostFont* font = &pt_host_fonts[canvas->font];
+    for(; *str; str++, x += font->advance) {
+        if(*str == ' ') continue;
+        canvas_draw_box(canvas, x, y - font->height + 1, font->advance - 1, font->height);
+    }
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    int32_t width = canvas_string_width(canvas, str);
+    int32_t height = pt_host_fonts[canvas->font].height;
+
+    if(horizontal == AlignRight) {
+        x -= width;
+    } else if(horizontal == AlignCenter) {
+        x -= width / 2;
+    }
+    if(vertical == AlignTop) {
+        y += height;
+    } else if(vertical == AlignCenter) {
+        y += height / 2;
+    }
+    canvas_draw_str(canvas, x, y, str);
+}
+
+// Elements
+
+void elements_multiline_text_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text) {
+    int32_t line_height = pt_host_fonts[canvas->font].height + 1;
+    int32_t lines = 1;
+    for(const char* c = text; *c; c++) {
+        if(*c == '\n') lines++;
+    }
+
+    if(vertical == AlignBottom) {
+        y -= lines * line_height;
+    } else if(vertical == AlignCenter) {
+        y -= lines * line_height / 2;
+    }
+
+    char line[PT_HOST_CANVAS_WIDTH];
+    while(true) {
+        const char* end = strchr(text, '\n');
+        size_t length = end ? (size_t)(end - text) : strlen(text);
+        length = MIN(length, sizeof(line) - 1);
+        memcpy(line, text, length);
+        line[length] = '\0';
+        canvas_draw_str_aligned(canvas, x, y, horizontal, AlignTop, line);
+        if(!end) break;
+        text = end + 1;
+        y += line_height;
+    }
+}
+
+void elements_slightly_rounded_box(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height) {
+    canvas_draw_box(canvas, x, y, width, height);
+    Color color = canvas->color;
+    canvas->color = color == ColorBlack ? ColorWhite : color;
+    canvas_draw_dot(canvas, x, y);
+    canvas_draw_dot(canvas, x + width - 1, y);
+    canvas_draw_dot(canvas, x, y + height - 1);
+    canvas_draw_dot(canvas, x + width - 1, y + height - 1);
+    canvas->color = color;
+}
+
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height) {
+    canvas_draw_box(canvas, x + 1, y, width - 2, 1);
+    canvas_draw_box(canvas, x + 1, y + height - 1, width - 2, 1);
+    canvas_draw_box(canvas, x, y + 1, 1, height - 2);
+    canvas_draw_box(canvas, x + width - 1, y + 1, 1, height - 2);
+}
+
+// GUI service
+
+struct Gui {
+    FuriThread* thread;
+    FuriPubSub* input_events;
+    FuriPubSubSubscription* input_subscription;
+    pthread_mutex_t lock; // Held while drawing and while the view on screen changes
+    pthread_mutex_t redraw_mutex;
+    pthread_cond_t redraw;
+    bool dirty;
+    bool stop;
+    ViewDispatcher* dispatcher;
+    Canvas canvas;
+    Canvas last_frame;
+};
+
+typedef enum {
+    PtHostDispatcherInput,
+    PtHostDispatcherCustom,
+    PtHostDispatcherStop,
+} PtHostDispatcherEventType;
+
+typedef struct {
+    PtHostDispatcherEventType type;
+    InputEvent input;
+    uint32_t custom;
+    uint64_t published_ns;
+} PtHostDispatcherEvent;
+
+struct View {
+    ViewDrawCallback draw_callback;
+    ViewInputCallback input_callback;
+    ViewNavigationCallback previous_callback;
+    void* context;
+    ViewModelType model_type;
+    void* model;
+    FuriMutex* model_mutex;
+    ViewOrientation orientation;
+    ViewDispatcher* dispatcher;
+    uint32_t id;
+};
+
+struct ViewDispatcher {
+    FuriMessageQueue* queue;
+    Gui* gui;
+    View* views[PT_HOST_VIEW_IDS];
+    View* current_view;
+    View* ongoing_input_view;
+    uint8_t ongoing_input;
+    void* event_context;
+    ViewDispatcherCustomEventCallback custom_event_callback;
+    ViewDispatcherNavigationEventCallback navigation_event_callback;
+    ViewDispatcherTickEventCallback tick_event_callback;
+    uint32_t tick_period;
+};
+
+static Gui* pt_host_gui = NULL;
+static PtHostDrawStats pt_host_draw[PT_HOST_VIEW_IDS];
+static PtHostInputStats pt_host_input;
+// Set on the app thread while it handles an input event, until the first model update
+static __thread uint64_t pt_host_input_published_ns = 0;
+
+static void pt_host_gui_request_redraw(Gui* gui) {
+    pthread_mutex_lock(&gui->redraw_mutex);
+    gui->dirty = true;
+    pthread_cond_signal(&gui->redraw);
+    pthread_mutex_unlock(&gui->redraw_mutex);
+}
+
+static void pt_host_gui_draw(Gui* gui) {
+    pthread_mutex_lock(&gui->lock);
+    View* view = gui->dispatcher ? gui->dispatcher->current_view : NULL;
+    if(view && view->draw_callback) {
+        pt_host_canvas_reset(&gui->canvas);
+        void* model = view_get_model(view);
+        uint32_t allocs = pt_host_thread_allocs();
+        uint64_t start = pt_host_now_ns();
+        view->draw_callback(&gui->canvas, model);
+        uint64_t took = pt_host_now_ns() - start;
+        allocs = pt_host_thread_allocs() - allocs;
+        view_commit_model(view, false);
+
+        if(view->id < PT_HOST_VIEW_IDS) {
+            PtHostDrawStats* stats = &pt_host_draw[view->id];
+            stats->frames++;
+            stats->total_ns += took;
+            stats->max_ns = MAX(stats->max_ns, took);
+            stats->allocs += allocs;
+        }
+        gui->last_frame = gui->canvas;
+    }
+    pthread_mutex_unlock(&gui->lock);
+}
+
+static int32_t pt_host_gui_thread(void* context) {
+    Gui* gui = context;
+    pthread_mutex_lock(&gui->redraw_mutex);
+    while(!gui->stop) {
+        if(!gui->dirty) {
+            pthread_cond_wait(&gui->redraw, &gui->redraw_mutex);
+            continue;
+        }
+        gui->dirty = false;
+        pthread_mutex_unlock(&gui->redraw_mutex);
+        pt_host_gui_draw(gui);
+        pthread_mutex_lock(&gui->redraw_mutex);
+    }
+    pthread_mutex_unlock(&gui->redraw_mutex);
+    return 0;
+}
+
+// Runs on whatever thread published the event, like the firmware the dispatcher queues it
+static void pt_host_gui_input_callback(const void* value, void* context) {
+    Gui* gui = context;
+    PtHostDispatcherEvent event = {
+        .type = PtHostDispatcherInput,
+        .input = *(const InputEvent*)value,
+        .published_ns = pt_host_now_ns(),
+    };
+    pthread_mutex_lock(&gui->lock);
+    ViewDispatcher* dispatcher = gui->dispatcher;
+    if(dispatcher) furi_message_queue_put(dispatcher->queue, &event, FuriWaitForever);
+    pthread_mutex_unlock(&gui->lock);
+}
+
+void pt_host_gui_start(void) {
+    Gui* gui = malloc(sizeof(Gui));
+    pthread_mutex_init(&gui->lock, NULL);
+    pthread_mutex_init(&gui->redraw_mutex, NULL);
+    pthread_cond_init(&gui->redraw, NULL);
+    pt_host_canvas_reset(&gui->last_frame);
+
+    gui->input_events = furi_record_open(RECORD_INPUT_EVENTS);
+    gui->input_subscription =
+        furi_pubsub_subscribe(gui->input_events, pt_host_gui_input_callback, gui);
+    gui->thread = furi_thread_alloc_ex("Gui", 2048, pt_host_gui_thread, gui);
+    furi_thread_start(gui->thread);
+
+    pt_host_gui = gui;
+    furi_record_create(RECORD_GUI, gui);
+}
+
+void pt_host_gui_stop(void) {
+    Gui* gui = pt_host_gui;
+    furi_record_create(RECORD_GUI, NULL);
+    furi_pubsub_unsubscribe(gui->input_events, gui->input_subscription);
+
+    pthread_mutex_lock(&gui->redraw_mutex);
+    gui->stop = true;
+    pthread_cond_signal(&gui->redraw);
+    pthread_mutex_unlock(&gui->redraw_mutex);
+    furi_thread_join(gui->thread);
+    furi_thread_free(gui->thread);
+
+    pthread_cond_destroy(&gui->redraw);
+    pthread_mutex_destroy(&gui->redraw_mutex);
+    pthread_mutex_destroy(&gui->lock);
+    pt_host_gui = NULL;
+    free(gui);
+}
+
+const PtHostDrawStats* pt_host_draw_stats(uint32_t view_id) {
+    furi_check(view_id < PT_HOST_VIEW_IDS);
+    return &pt_host_draw[view_id];
+}
+
+const PtHostInputStats* pt_host_input_stats(void) {
+    return &pt_host_input;
+}
+
+void pt_host_gui_reset_stats(void) {
+    memset(pt_host_draw, 0, sizeof(pt_host_draw));
+    memset(&pt_host_input, 0, sizeof(pt_host_input));
+}
+
+uint32_t pt_host_gui_current_view(void) {
+    Gui* gui = pt_host_gui;
+    uint32_t id = VIEW_NONE;
+    pthread_mutex_lock(&gui->lock);
+    if(gui->dispatcher && gui->dispatcher->current_view) id = gui->dispatcher->current_view->id;
+    pthread_mutex_unlock(&gui->lock);
+    return id;
+}
+
+void pt_host_gui_dump(FILE* stream) {
+    Gui* gui = pt_host_gui;
+    pthread_mutex_lock(&gui->lock);
+    for(size_t y = 0; y < PT_HOST_CANVAS_HEIGHT; y++) {
+        for(size_t x = 0; x < PT_HOST_CANVAS_WIDTH; x++) {
+            fputc(gui->last_frame.pixels[y][x] ? '#' : '.', stream);
+        }
+        fputc('\n', stream);
+    }
+    pthread_mutex_unlock(&gui->lock);
+}
+
+// View
+
+View* view_alloc(void) {
+    View* view = malloc(sizeof(View));
+    view->model_type = ViewModelTypeNone;
+    view->id = VIEW_NONE;
+    return view;
+}
+
+void view_free(View* view) {
+    furi_check(!view->dispatcher);
+    if(view->model_mutex) furi_mutex_free(view->model_mutex);
+    free(view->model);
+    free(view);
+}
+
+void view_set_context(View* view, void* context) {
+    view->context = context;
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback) {
+    view->draw_callback = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback) {
+    view->input_callback = callback;
+}
+
+void view_set_previous_callback(View* view, ViewNavigationCallback callback) {
+    view->previous_callback = callback;
+}
+
+void view_set_orientation(View* view, ViewOrientation orientation) {
+    view->orientation = orientation;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size) {
+    furi_check(view->model_type == ViewModelTypeNone && type != ViewModelTypeNone);
+    view->model_type = type;
+    view->model = malloc(size);
+    if(type == ViewModelTypeLocking) view->model_mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
+}
+
+void* view_get_model(View* view) {
+    if(view->model_type == ViewModelTypeLocking) {
+        furi_check(furi_mutex_acquire(view->model_mutex, FuriWaitForever) == FuriStatusOk);
+    }
+    return view->model;
+}
+
+void view_commit_model(View* view, bool update) {
+    if(view->model_type == ViewModelTypeLocking) {
+        furi_check(furi_mutex_release(view->model_mutex) == FuriStatusOk);
+    }
+    if(!update) return;
+
+    if(pt_host_input_published_ns) {
+        uint64_t latency = pt_host_now_ns() - pt_host_input_published_ns;
+        pt_host_input.updates++;
+        pt_host_input.update_total_ns += latency;
+        pt_host_input.update_max_ns = MAX(pt_host_input.update_max_ns, latency);
+        pt_host_input_published_ns = 0;
+    }
+
+    ViewDispatcher* dispatcher = view->dispatcher;
+    if(dispatcher && dispatcher->gui && dispatcher->current_view == view) {
+        pt_host_gui_request_redraw(dispatcher->gui);
+    }
+}
+
+// View dispatcher
+
+ViewDispatcher* view_dispatcher_alloc(void) {
+    ViewDispatcher* dispatcher = malloc(sizeof(ViewDispatcher));
+    dispatcher->queue =
+        furi_message_queue_alloc(PT_HOST_DISPATCHER_QUEUE, sizeof(PtHostDispatcherEvent));
+    dispatcher->tick_period = FuriWaitForever;
+    return dispatcher;
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
+    Gui* gui = view_dispatcher->gui;
+    if(gui) {
+        pthread_mutex_lock(&gui->lock);
+        gui->dispatcher = NULL;
+        pthread_mutex_unlock(&gui->lock);
+    }
+    for(size_t i = 0; i < PT_HOST_VIEW_IDS; i++) {
+        furi_check(!view_dispatcher->views[i]);
+    }
+    furi_message_queue_free(view_dispatcher->queue);
+    free(view_dispatcher);
+}
+
+void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context) {
+    view_dispatcher->event_context = context;
+}
+
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback) {
+    view_dispatcher->custom_event_callback = callback;
+}
+
+void view_dispatcher_set_navigation_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherNavigationEventCallback callback) {
+    view_dispatcher->navigation_event_callback = callback;
+}
+
+void view_dispatcher_set_tick_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherTickEventCallback callback,
+    uint32_t tick_period) {
+    view_dispatcher->tick_event_callback = callback;
+    view_dispatcher->tick_period = tick_period;
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type) {
+    UNUSED(type);
+    pthread_mutex_lock(&gui->lock);
+    furi_check(!gui->dispatcher);
+    gui->dispatcher = view_dispatcher;
+    view_dispatcher->gui = gui;
+    pthread_mutex_unlock(&gui->lock);
+}
+
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
+    furi_check(view_id < PT_HOST_VIEW_IDS && !view_dispatcher->views[view_id]);
+    furi_check(!view->dispatcher);
+    view_dispatcher->views[view_id] = view;
+    view->dispatcher = view_dispatcher;
+    view->id = view_id;
+}
+
+static void pt_host_dispatcher_set_view(ViewDispatcher* view_dispatcher, View* view) {
+    Gui* gui = view_dispatcher->gui;
+    if(gui) pthread_mutex_lock(&gui->lock);
+    view_dispatcher->current_view = view;
+    if(gui) pthread_mutex_unlock(&gui->lock);
+    if(gui && view) pt_host_gui_request_redraw(gui);
+}
+
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    furi_check(view_id < PT_HOST_VIEW_IDS);
+    View* view = view_dispatcher->views[view_id];
+    furi_check(view);
+    if(view_dispatcher->current_view == view) pt_host_dispatcher_set_view(view_dispatcher, NULL);
+    if(view_dispatcher->ongoing_input_view == view) view_dispatcher->ongoing_input_view = NULL;
+    view_dispatcher->views[view_id] = NULL;
+    view->dispatcher = NULL;
+}
+
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    if(view_id == VIEW_NONE) {
+        pt_host_dispatcher_set_view(view_dispatcher, NULL);
+        view_dispatcher_stop(view_dispatcher);
+        return;
+    }
+    if(view_id == VIEW_IGNORE) return;
+    furi_check(view_id < PT_HOST_VIEW_IDS && view_dispatcher->views[view_id]);
+    pt_host_dispatcher_set_view(view_dispatcher, view_dispatcher->views[view_id]);
+}
+
+void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t event) {
+    PtHostDispatcherEvent message = {.type = PtHostDispatcherCustom, .custom = event};
+    furi_check(
+        furi_message_queue_put(view_dispatcher->queue, &message, FuriWaitForever) ==
+        FuriStatusOk);
+}
+
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher) {
+    PtHostDispatcherEvent message = {.type = PtHostDispatcherStop};
+    furi_message_queue_put(view_dispatcher->queue, &message, FuriWaitForever);
+}
+
+// A key's events all go to the view that had its Press, so a Release still reaches the
+// view that was on screen when the key went down
+static void pt_host_dispatcher_input(ViewDispatcher* view_dispatcher, InputEvent* event) {
+    uint8_t key_bit = 1 << event->key;
+    if(event->type == InputTypePress) {
+        if(!view_dispatcher->ongoing_input) {
+            view_dispatcher->ongoing_input_view = view_dispatcher->current_view;
+        }
+        view_dispatcher->ongoing_input |= key_bit;
+    } else if(!(view_dispatcher->ongoing_input & key_bit)) {
+        return;
+    }
+
+    View* current = view_dispatcher->current_view;
+    bool consumed = false;
+    if(current && view_dispatcher->ongoing_input_view == current) {
+        if(current->input_callback) consumed = current->input_callback(event, current->context);
+    } else if(view_dispatcher->ongoing_input_view && event->type == InputTypeRelease) {
+        View* view = view_dispatcher->ongoing_input_view;
+        if(view->input_callback) view->input_callback(event, view->context);
+    }
+
+    if(event->type == InputTypeRelease) {
+        view_dispatcher->ongoing_input &= ~key_bit;
+        if(!view_dispatcher->ongoing_input) {
+            view_dispatcher->ongoing_input_view = view_dispatcher->current_view;
+        }
+    }
+
+    if(consumed || event->type != InputTypeShort || event->key != InputKeyBack) return;
+
+    // Back nobody wanted: the view's previous one, else the app's navigation callback
+    uint32_t view_id = VIEW_IGNORE;
+    if(current && current->previous_callback) view_id = current->previous_callback(current->context);
+    if(view_id == VIEW_IGNORE && view_dispatcher->navigation_event_callback) {
+        if(!view_dispatcher->navigation_event_callback(view_dispatcher->event_context)) {
+            view_dispatcher_stop(view_dispatcher);
+        }
+        return;
+    }
+    view_dispatcher_switch_to_view(view_dispatcher, view_id);
+}
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
+    PtHostDispatcherEvent event;
+    while(true) {
+        FuriStatus status = furi_message_queue_get(
+            view_dispatcher->queue, &event, view_dispatcher->tick_period);
+        if(status != FuriStatusOk) {
+            if(view_dispatcher->tick_event_callback) {
+                view_dispatcher->tick_event_callback(view_dispatcher->event_context);
+            }
+            continue;
+        }
+
+        if(event.type == PtHostDispatcherStop) break;
+        if(event.type == PtHostDispatcherCustom) {
+            if(view_dispatcher->custom_event_callback) {
+                view_dispatcher->custom_event_callback(
+                    view_dispatcher->event_context, event.custom);
+            }
+            continue;
+        }
+
+        pt_host_input_published_ns = event.published_ns;
+        pt_host_dispatcher_input(view_dispatcher, &event.input);
+        pt_host_input_published_ns = 0;
+
+        uint64_t handled = pt_host_now_ns() - event.published_ns;
+        pt_host_input.events++;
+        pt_host_input.handled_total_ns += handled;
+        pt_host_input.handled_max_ns = MAX(pt_host_input.handled_max_ns, handled);
+    }
+}
+
+// Scene manager
+
+struct SceneManager {
+    const SceneManagerHandlers* handlers;
+    void* context;
+    uint32_t* states;
+    uint32_t stack[PT_HOST_SCENE_DEPTH];
+    size_t depth;
+};
+
+SceneManager* scene_manager_alloc(const SceneManagerHandlers* app_scene_handlers, void* context) {
+    SceneManager* scene_manager = malloc(sizeof(SceneManager));
+    scene_manager->handlers = app_scene_handlers;
+    scene_manager->context = context;
+    scene_manager->states = malloc(app_scene_handlers->scene_num * sizeof(uint32_t));
+    return scene_manager;
+}
+
+void scene_manager_free(SceneManager* scene_manager) {
+    // Scenes still on the stack are left without their on_exit, like the firmware does
+    free(scene_manager->states);
+    free(scene_manager);
+}
+
+void scene_manager_set_scene_state(SceneManager* scene_manager, uint32_t scene_id, uint32_t state) {
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    scene_manager->states[scene_id] = state;
+}
+
+uint32_t scene_manager_get_scene_state(const SceneManager* scene_manager, uint32_t scene_id) {
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    return scene_manager->states[scene_id];
+}
+
+static uint32_t pt_host_scene_current(const SceneManager* scene_manager) {
+    furi_check(scene_manager->depth);
+    return scene_manager->stack[scene_manager->depth - 1];
+}
+
+bool scene_manager_handle_custom_event(SceneManager* scene_manager, uint32_t custom_event) {
+    if(!scene_manager->depth) return false;
+    SceneManagerEvent event = {.type = SceneManagerEventTypeCustom, .event = custom_event};
+    return scene_manager->handlers->on_event_handlers[pt_host_scene_current(scene_manager)](
+        scene_manager->context, event);
+}
+
+bool scene_manager_handle_back_event(SceneManager* scene_manager) {
+    SceneManagerEvent event = {.type = SceneManagerEventTypeBack};
+    bool consumed = scene_manager->handlers->on_event_handlers[pt_host_scene_current(
+        scene_manager)](scene_manager->context, event);
+    if(!consumed) consumed = scene_manager_previous_scene(scene_manager);
+    return consumed;
+}
+
+void scene_manager_next_scene(SceneManager* scene_manager, uint32_t next_scene_id) {
+    furi_check(next_scene_id < scene_manager->handlers->scene_num);
+    furi_check(scene_manager->depth < PT_HOST_SCENE_DEPTH);
+    if(scene_manager->depth) {
+        scene_manager->handlers->on_exit_handlers[pt_host_scene_current(scene_manager)](
+            scene_manager->context);
+    }
+    scene_manager->stack[scene_manager->depth++] = next_scene_id;
+    scene_manager->handlers->on_enter_handlers[next_scene_id](scene_manager->context);
+}
+
+bool scene_manager_previous_scene(SceneManager* scene_manager) {
+    if(!scene_manager->depth) return false;
+    uint32_t scene_id = scene_manager->stack[--scene_manager->depth];
+    scene_manager->handlers->on_exit_handlers[scene_id](scene_manager->context);
+    if(!scene_manager->depth) return false;
+    scene_manager->handlers->on_enter_handlers[pt_host_scene_current(scene_manager)](
+        scene_manager->context);
+    return true;
+}
+
+bool scene_manager_search_and_switch_to_previous_scene(
+    SceneManager* scene_manager,
+    uint32_t scene_id) {
+    size_t depth = scene_manager->depth;
+    while(depth && scene_manager->stack[depth - 1] != scene_id) depth--;
+    if(!depth) return false;
+
+    scene_manager->handlers->on_exit_handlers[pt_host_scene_current(scene_manager)](
+        scene_manager->context);
+    scene_manager->depth = depth;
+    scene_manager->handlers->on_enter_handlers[scene_id](scene_manager->context);
+    return true;
+}
+
+// Submenu
+
+typedef struct {
+    char label[PT_HOST_SUBMENU_LABEL + 1];
+    uint32_t index;
+    SubmenuItemCallback callback;
+    void* callback_context;
+} PtHostSubmenuItem;
+
+typedef struct {
+    PtHostSubmenuItem items[PT_HOST_SUBMENU_ITEMS];
+    size_t count;
+    size_t selected;
+    char header[PT_HOST_SUBMENU_LABEL + 1];
+} PtHostSubmenuModel;
+
+struct Submenu {
+    View* view;
+};
+
+static void pt_host_submenu_draw(Canvas* canvas, void* model) {
+    PtHostSubmenuModel* menu = model;
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontPrimary);
+    canvas_draw_str(canvas, 2, 10, menu->header);
+    canvas_set_font(canvas, FontSecondary);
+
+    size_t first = menu->selected >= PT_HOST_SUBMENU_ROWS ?
+                       menu->selected - PT_HOST_SUBMENU_ROWS + 1 :
+                       0;
+    for(size_t row = 0; row < PT_HOST_SUBMENU_ROWS && first + row < menu->count; row++) {
+        int32_t y = 24 + row * 12;
+        if(first + row == menu->selected) {
+            elements_slightly_rounded_box(canvas, 0, y - 9, 123, 12);
+            canvas_set_color(canvas, ColorWhite);
+        }
+        canvas_draw_str(canvas, 6, y, menu->items[first + row].label);
+        canvas_set_color(canvas, ColorBlack);
+    }
+}
+
+static bool pt_host_submenu_input(InputEvent* event, void* context) {
+    Submenu* submenu = context;
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) return false;
+
+    PtHostSubmenuItem picked = {0};
+    bool consumed = true;
+    with_view_model(
+        submenu->view,
+        PtHostSubmenuModel * model,
+        {
+            if(!model->count) {
+                consumed = false;
+            } else if(event->key == InputKeyUp) {
+                model->selected = (model->selected + model->count - 1) % model->count;
+            } else if(event->key == InputKeyDown) {
+                model->selected = (model->selected + 1) % model->count;
+            } else if(event->key == InputKeyOk && event->type == InputTypeShort) {
+                picked = model->items[model->selected];
+            } else {
+                consumed = false;
+            }
+        },
+        consumed);
+
+    if(picked.callback) picked.callback(picked.callback_context, picked.index);
+    return consumed;
+}
+
+Submenu* submenu_alloc(void) {
+    Submenu* submenu = malloc(sizeof(Submenu));
+    submenu->view = view_alloc();
+    view_set_context(submenu->view, submenu);
+    view_allocate_model(submenu->view, ViewModelTypeLocking, sizeof(PtHostSubmenuModel));
+    view_set_draw_callback(submenu->view, pt_host_submenu_draw);
+    view_set_input_callback(submenu->view, pt_host_submenu_input);
+    return submenu;
+}
+
+void submenu_free(Submenu* submenu) {
+    view_free(submenu->view);
+    free(submenu);
+}
+
+View* submenu_get_view(Submenu* submenu) {
+    return submenu->view;
+}
+
+void submenu_add_item(
+    Submenu* submenu,
+    const char* label,
+    uint32_t index,
+    SubmenuItemCallback callback,
+    void* callback_context) {
+    with_view_model(
+        submenu->view,
+        PtHostSubmenuModel * model,
+        {
+            furi_check(model->count < PT_HOST_SUBMENU_ITEMS);
+            PtHostSubmenuItem* item = &model->items[model->count++];
+            strlcpy(item->label, label, sizeof(item->label));
+            item->index = index;
+            item->callback = callback;
+            item->callback_context = callback_context;
+        },
+        true);
+}
+
+void submenu_reset(Submenu* submenu) {
+    with_view_model(
+        submenu->view,
+        PtHostSubmenuModel * model,
+        {
+            model->count = 0;
+            model->selected = 0;
+            model->header[0] = '\0';
+        },
+        true);
+}
+
+void submenu_set_header(Submenu* submenu, const char* header) {
+    with_view_model(
+        submenu->view,
+        PtHostSubmenuModel * model,
+        { strlcpy(model->header, header ? header : "", sizeof(model->header)); },
+        true);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <gui/canvas.h>
+
+void elements_multiline_text_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* text);
+void elements_slightly_rounded_box(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height);
+void elements_slightly_rounded_frame(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height);
@@ -0,0 +1,10 @@
+#pragma once
+
+// The GUI service: its own thread draws the view on screen whenever a model commit asks
+// for it, and input events published by the input service go to the attached dispatcher
+
+#include <gui/canvas.h>
+
+#define RECORD_GUI "gui"
+
+typedef struct Gui Gui;
@@ -0,0 +1,41 @@
+#pragma once
+
+// The firmware's scene stack: leaving the first scene ends previous_scene with false
+
+#include <furi.h>
+
+typedef enum {
+    SceneManagerEventTypeCustom,
+    SceneManagerEventTypeBack,
+    SceneManagerEventTypeTick,
+} SceneManagerEventType;
+
+typedef struct {
+    SceneManagerEventType type;
+    uint32_t event;
+} SceneManagerEvent;
+
+typedef void (*AppSceneOnEnterCallback)(void* context);
+typedef bool (*AppSceneOnEventCallback)(void* context, SceneManagerEvent event);
+typedef void (*AppSceneOnExitCallback)(void* context);
+
+typedef struct {
+    const AppSceneOnEnterCallback* on_enter_handlers;
+    const AppSceneOnEventCallback* on_event_handlers;
+    const AppSceneOnExitCallback* on_exit_handlers;
+    const uint32_t scene_num;
+} SceneManagerHandlers;
+
+typedef struct SceneManager SceneManager;
+
+SceneManager* scene_manager_alloc(const SceneManagerHandlers* app_scene_handlers, void* context);
+void scene_manager_free(SceneManager* scene_manager);
+void scene_manager_set_scene_state(SceneManager* scene_manager, uint32_t scene_id, uint32_t state);
+uint32_t scene_manager_get_scene_state(const SceneManager* scene_manager, uint32_t scene_id);
+bool scene_manager_handle_custom_event(SceneManager* scene_manager, uint32_t custom_event);
+bool scene_manager_handle_back_event(SceneManager* scene_manager);
+void scene_manager_next_scene(SceneManager* scene_manager, uint32_t next_scene_id);
+bool scene_manager_previous_scene(SceneManager* scene_manager);
+bool scene_manager_search_and_switch_to_previous_scene(
+    SceneManager* scene_manager,
+    uint32_t scene_id);
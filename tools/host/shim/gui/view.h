@@ -0,0 +1,49 @@
+#pragma once
+
+// Views with the firmware's model semantics: a locking model holds its mutex from
+// view_get_model to view_commit_model, the draw callback gets the model and not the
+// context, and committing with update asks the GUI thread for a redraw.
+
+#include <furi.h>
+#include <input/input.h>
+#include <gui/canvas.h>
+
+#define VIEW_NONE   0xFFFFFFFF
+#define VIEW_IGNORE 0xFFFFFFFE
+
+typedef enum {
+    ViewOrientationHorizontal,
+    ViewOrientationHorizontalFlip,
+    ViewOrientationVertical,
+    ViewOrientationVerticalFlip,
+} ViewOrientation;
+
+typedef enum {
+    ViewModelTypeNone,
+    ViewModelTypeLockFree,
+    ViewModelTypeLocking,
+} ViewModelType;
+
+typedef struct View View;
+
+typedef void (*ViewDrawCallback)(Canvas* canvas, void* model);
+typedef bool (*ViewInputCallback)(InputEvent* event, void* context);
+typedef uint32_t (*ViewNavigationCallback)(void* context);
+
+View* view_alloc(void);
+void view_free(View* view);
+void view_set_context(View* view, void* context);
+void view_set_draw_callback(View* view, ViewDrawCallback callback);
+void view_set_input_callback(View* view, ViewInputCallback callback);
+void view_set_previous_callback(View* view, ViewNavigationCallback callback);
+void view_set_orientation(View* view, ViewOrientation orientation);
+void view_allocate_model(View* view, ViewModelType type, size_t size);
+void* view_get_model(View* view);
+void view_commit_model(View* view, bool update);
+
+#define with_view_model(view, type, code, update) \
+    {                                             \
+        type = view_get_model(view);              \
+        {code};                                   \
+        view_commit_model(view, update);          \
+    }
@@ -0,0 +1,546 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <infrared.h>
+#include <infrared_worker.h>
+#include <infrared_transmit.h>
+#include <pt_host.h>
+#include <pthread.h>
+
+#define PT_HOST_NEC_HEADER_MARK  9000
+#define PT_HOST_NEC_HEADER_SPACE 4500
+#define PT_HOST_NEC_BIT_MARK     560
+#define PT_HOST_NEC_ZERO_SPACE   560
+#define PT_HOST_NEC_ONE_SPACE    1690
+#define PT_HOST_NEC_BITS         32
+// What the encoder sends for every protocol it doesn't know
+#define PT_HOST_PLACEHOLDER_MARK 560
+
+#define PT_HOST_WORKER_TIMINGS 1024
+#define PT_HOST_TRANSMISSIONS  64
+
+// Protocols
+
+typedef struct {
+    const char* name;
+    uint32_t frequency;
+    size_t min_repeat;
+} PtHostProtocol;
+
+static const PtHostProtocol pt_host_protocols[InfraredProtocolMAX] = {
+    [InfraredProtocolNEC] = {"NEC", 38000, 1},
+    [InfraredProtocolNECext] = {"NECext", 38000, 1},
+    [InfraredProtocolNEC42] = {"NEC42", 38000, 1},
+    [InfraredProtocolNEC42ext] = {"NEC42ext", 38000, 1},
+    [InfraredProtocolSamsung32] = {"Samsung32", 38000, 1},
+    [InfraredProtocolRC6] = {"RC6", 36000, 1},
+    [InfraredProtocolRC5] = {"RC5", 36000, 1},
+    [InfraredProtocolRC5X] = {"RC5X", 36000, 1},
+    [InfraredProtocolSIRC] = {"SIRC", 40000, 3},
+    [InfraredProtocolSIRC15] = {"SIRC15", 40000, 3},
+    [InfraredProtocolSIRC20] = {"SIRC20", 40000, 3},
+    [InfraredProtocolKaseikyo] = {"Kaseikyo", 37000, 1},
+    [InfraredProtocolRCA] = {"RCA", 38000, 2},
+    [InfraredProtocolPioneer] = {"Pioneer", 40000, 2},
+};
+
+InfraredProtocol infrared_get_protocol_by_name(const char* protocol_name) {
+    for(int i = 0; i < InfraredProtocolMAX; i++) {
+        if(strcmp(pt_host_protocols[i].name, protocol_name) == 0) return (InfraredProtocol)i;
+    }
+    return InfraredProtocolUnknown;
+}
+
+const char* infrared_get_protocol_name(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? pt_host_protocols[protocol].name : "Invalid";
+}
+
+bool infrared_is_protocol_valid(InfraredProtocol protocol) {
+    return protocol >= 0 && protocol < InfraredProtocolMAX;
+}
+
+uint32_t infrared_get_protocol_frequency(InfraredProtocol protocol) {
+    furi_check(infrared_is_protocol_valid(protocol));
+    return pt_host_protocols[protocol].frequency;
+}
+
+float infrared_get_protocol_duty_cycle(InfraredProtocol protocol) {
+    furi_check(infrared_is_protocol_valid(protocol));
+    return INFRARED_COMMON_DUTY_CYCLE;
+}
+
+size_t infrared_get_protocol_min_repeat_count(InfraredProtocol protocol) {
+    furi_check(infrared_is_protocol_valid(protocol));
+    return pt_host_protocols[protocol].min_repeat;
+}
+
+// NEC decoder, the frame has to start at the header mark
+
+struct InfraredDecoderHandler {
+    size_t step; // Timings of the current frame taken so far
+    uint32_t data;
+    bool ready;
+    InfraredMessage message;
+};
+
+static bool pt_host_nec_match(uint32_t duration, uint32_t expected) {
+    return duration >= expected - expected / 4 && duration <= expected + expected / 4;
+}
+
+InfraredDecoderHandler* infrared_alloc_decoder(void) {
+    return malloc(sizeof(InfraredDecoderHandler));
+}
+
+void infrared_free_decoder(InfraredDecoderHandler* handler) {
+    free(handler);
+}
+
+void infrared_reset_decoder(InfraredDecoderHandler* handler) {
+    memset(handler, 0, sizeof(InfraredDecoderHandler));
+}
+
+static const InfraredMessage* pt_host_nec_message(InfraredDecoderHandler* handler) {
+    uint8_t address = handler->data;
+    uint8_t address_inverse = handler->data >> 8;
+    uint8_t command = handler->data >> 16;
+    uint8_t command_inverse = handler->data >> 24;
+    handler->step = 0;
+    handler->ready = false;
+
+    if((address ^ address_inverse) == 0xFF && (command ^ command_inverse) == 0xFF) {
+        handler->message = (InfraredMessage){
+            .protocol = InfraredProtocolNEC, .address = address, .command = command};
+    } else {
+        handler->message = (InfraredMessage){
+            .protocol = InfraredProtocolNECext,
+            .address = handler->data & 0xFFFF,
+            .command = handler->data >> 16,
+        };
+    }
+    return &handler->message;
+}
+
+const InfraredMessage*
+    infrared_decode(InfraredDecoderHandler* handler, bool level, uint32_t duration) {
+    size_t step = handler->step;
+    bool valid;
+    if(step == 0) {
+        valid = level && pt_host_nec_match(duration, PT_HOST_NEC_HEADER_MARK);
+    } else if(step == 1) {
+        valid = !level && pt_host_nec_match(duration, PT_HOST_NEC_HEADER_SPACE);
+    } else if(step % 2 == 0) {
+        valid = level && pt_host_nec_match(duration, PT_HOST_NEC_BIT_MARK);
+        // The stop mark after the last bit ends the frame
+        if(valid && step == 2 + PT_HOST_NEC_BITS * 2) return pt_host_nec_message(handler);
+    } else {
+        size_t bit = (step - 3) / 2;
+        valid = !level;
+        if(valid && pt_host_nec_match(duration, PT_HOST_NEC_ONE_SPACE)) {
+            handler->data |= 1UL << bit;
+        } else if(!valid || !pt_host_nec_match(duration, PT_HOST_NEC_ZERO_SPACE)) {
+            valid = false;
+        }
+    }
+
+    if(!valid) {
+        infrared_reset_decoder(handler);
+        return NULL;
+    }
+    handler->step++;
+    handler->ready = handler->step == 2 + PT_HOST_NEC_BITS * 2;
+    return NULL;
+}
+
+// A frame that has all its bits but hasn't seen the stop mark yet
+const InfraredMessage* infrared_check_decoder_ready(InfraredDecoderHandler* handler) {
+    return handler->ready ? pt_host_nec_message(handler) : NULL;
+}
+
+// Encoder
+
+struct InfraredEncoderHandler {
+    InfraredMessage message;
+    uint32_t data;
+    size_t step;
+};
+
+InfraredEncoderHandler* infrared_alloc_encoder(void) {
+    return malloc(sizeof(InfraredEncoderHandler));
+}
+
+void infrared_free_encoder(InfraredEncoderHandler* handler) {
+    free(handler);
+}
+
+void infrared_reset_encoder(InfraredEncoderHandler* handler, const InfraredMessage* message) {
+    handler->message = *message;
+    handler->step = 0;
+    if(message->protocol == InfraredProtocolNEC) {
+        uint8_t address = message->address;
+        uint8_t command = message->command;
+        handler->data = address | (uint8_t)~address << 8 | command << 16 |
+                        (uint32_t)(uint8_t)~command << 24;
+    } else {
+        handler->data = (message->address & 0xFFFF) | (message->command & 0xFFFF) << 16;
+    }
+}
+
+// Every call hands out one timing, Done comes with the last one of a frame
+InfraredStatus infrared_encode(InfraredEncoderHandler* handler, uint32_t* duration, bool* level) {
+    InfraredProtocol protocol = handler->message.protocol;
+    size_t step = handler->step++;
+    *level = !(step % 2);
+
+    if(protocol != InfraredProtocolNEC && protocol != InfraredProtocolNECext) {
+        *duration = PT_HOST_PLACEHOLDER_MARK;
+        handler->step = 0;
+        return InfraredStatusDone;
+    }
+
+    if(step == 0) {
+        *duration = PT_HOST_NEC_HEADER_MARK;
+    } else if(step == 1) {
+        *duration = PT_HOST_NEC_HEADER_SPACE;
+    } else if(step % 2 == 0) {
+        *duration = PT_HOST_NEC_BIT_MARK;
+        if(step == 2 + PT_HOST_NEC_BITS * 2) {
+            handler->step = 0;
+            return InfraredStatusDone;
+        }
+    } else {
+        bool one = handler->data & (1UL << ((step - 3) / 2));
+        *duration = one ? PT_HOST_NEC_ONE_SPACE : PT_HOST_NEC_ZERO_SPACE;
+    }
+    return InfraredStatusOk;
+}
+
+// Receiver
+
+struct InfraredWorkerSignal {
+    bool decoded;
+    InfraredMessage message;
+    size_t timings_size;
+    uint32_t timings[PT_HOST_WORKER_TIMINGS];
+};
+
+struct InfraredWorker {
+    FuriThread* thread;
+    InfraredWorkerReceivedSignalCallback callback;
+    void* context;
+    bool decoding;
+    bool running;
+    InfraredDecoderHandler* decoder;
+    InfraredWorkerSignal signal;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    bool pending; // signal holds a capture the thread hasn't delivered yet
+    bool stop;
+};
+
+static pthread_mutex_t pt_host_receiver_mutex = PTHREAD_MUTEX_INITIALIZER;
+static InfraredWorker* pt_host_receiver = NULL;
+
+static int32_t pt_host_worker_thread(void* context) {
+    InfraredWorker* worker = context;
+    pthread_mutex_lock(&worker->mutex);
+    while(!worker->stop) {
+        if(!worker->pending) {
+            pthread_cond_wait(&worker->changed, &worker->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&worker->mutex);
+
+        InfraredWorkerSignal* signal = &worker->signal;
+        signal->decoded = false;
+        if(worker->decoding) {
+            // Live decoding sees the capture once, from its first timing
+            infrared_reset_decoder(worker->decoder);
+            const InfraredMessage* message = NULL;
+            for(size_t i = 0; i < signal->timings_size && !message; i++) {
+                message = infrared_decode(worker->decoder, !(i % 2), signal->timings[i]);
+            }
+            if(!message) message = infrared_check_decoder_ready(worker->decoder);
+            if(message) {
+                signal->decoded = true;
+                signal->message = *message;
+            }
+        }
+        if(worker->callback) worker->callback(worker->context, signal);
+
+        pthread_mutex_lock(&worker->mutex);
+        worker->pending = false;
+        pthread_cond_broadcast(&worker->changed);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+    return 0;
+}
+
+InfraredWorker* infrared_worker_alloc(void) {
+    InfraredWorker* worker = malloc(sizeof(InfraredWorker));
+    worker->decoder = infrared_alloc_decoder();
+    worker->thread = furi_thread_alloc_ex("InfraredWorker", 2048, pt_host_worker_thread, worker);
+    pthread_mutex_init(&worker->mutex, NULL);
+    pthread_cond_init(&worker->changed, NULL);
+    return worker;
+}
+
+void infrared_worker_free(InfraredWorker* instance) {
+    furi_check(!instance->running);
+    furi_thread_free(instance->thread);
+    infrared_free_decoder(instance->decoder);
+    pthread_cond_destroy(&instance->changed);
+    pthread_mutex_destroy(&instance->mutex);
+    free(instance);
+}
+
+void infrared_worker_rx_start(InfraredWorker* instance) {
+    furi_check(!instance->running);
+    instance->stop = false;
+    instance->pending = false;
+    instance->running = true;
+    furi_thread_start(instance->thread);
+
+    pthread_mutex_lock(&pt_host_receiver_mutex);
+    pt_host_receiver = instance;
+    pthread_mutex_unlock(&pt_host_receiver_mutex);
+}
+
+void infrared_worker_rx_stop(InfraredWorker* instance) {
+    furi_check(instance->running);
+    furi_check(furi_thread_get_current_id() != (FuriThreadId)instance->thread);
+
+    pthread_mutex_lock(&pt_host_receiver_mutex);
+    if(pt_host_receiver == instance) pt_host_receiver = NULL;
+    pthread_mutex_unlock(&pt_host_receiver_mutex);
+
+    pthread_mutex_lock(&instance->mutex);
+    instance->stop = true;
+    pthread_cond_broadcast(&instance->changed);
+    pthread_mutex_unlock(&instance->mutex);
+    furi_thread_join(instance->thread);
+    instance->running = false;
+}
+
+void infrared_worker_rx_set_received_signal_callback(
+    InfraredWorker* instance,
+    InfraredWorkerReceivedSignalCallback callback,
+    void* context) {
+    instance->callback = callback;
+    instance->context = context;
+}
+
+void infrared_worker_rx_enable_blink_on_receiving(InfraredWorker* instance, bool enable) {
+    UNUSED(instance);
+    UNUSED(enable);
+}
+
+void infrared_worker_rx_enable_signal_decoding(InfraredWorker* instance, bool enable) {
+    instance->decoding = enable;
+}
+
+bool infrared_worker_signal_is_decoded(const InfraredWorkerSignal* signal) {
+    return signal->decoded;
+}
+
+void infrared_worker_get_raw_signal(
+    const InfraredWorkerSignal* signal,
+    const uint32_t** timings,
+    size_t* timings_cnt) {
+    furi_check(!signal->decoded);
+    *timings = signal->timings;
+    *timings_cnt = signal->timings_size;
+}
+
+const InfraredMessage* infrared_worker_get_decoded_signal(const InfraredWorkerSignal* signal) {
+    furi_check(signal->decoded);
+    return &signal->message;
+}
+
+// Waits for the previous capture to be delivered, then hands this one to the worker
+bool pt_host_infrared_receive(const uint32_t* timings, size_t timings_size) {
+    furi_check(timings_size && timings_size <= PT_HOST_WORKER_TIMINGS);
+    pthread_mutex_lock(&pt_host_receiver_mutex);
+    InfraredWorker* worker = pt_host_receiver;
+    if(!worker) {
+        pthread_mutex_unlock(&pt_host_receiver_mutex);
+        return false;
+    }
+
+    pthread_mutex_lock(&worker->mutex);
+    while(worker->pending && !worker->stop) {
+        pthread_cond_wait(&worker->changed, &worker->mutex);
+    }
+    bool taken = !worker->stop;
+    if(taken) {
+        memcpy(worker->signal.timings, timings, timings_size * sizeof(uint32_t));
+        worker->signal.timings_size = timings_size;
+        worker->pending = true;
+        pthread_cond_broadcast(&worker->changed);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+    pthread_mutex_unlock(&pt_host_receiver_mutex);
+    return taken;
+}
+
+// Transmitter
+
+static pthread_mutex_t pt_host_tx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PtHostTransmission pt_host_tx_log[PT_HOST_TRANSMISSIONS];
+static size_t pt_host_tx_count = 0;
+static bool pt_host_external = false;
+static FuriHalInfraredTxPin pt_host_tx_pin = FuriHalInfraredTxPinInternal;
+static uint32_t pt_host_otg_enables = 0;
+static bool pt_host_otg_on = false;
+
+static FuriHalInfraredTxGetDataISRCallback pt_host_tx_callback = NULL;
+static void* pt_host_tx_context = NULL;
+static uint64_t pt_host_tx_done_ns = 0;
+
+// Logs a transmission and returns how long it is on air
+static uint32_t pt_host_tx_log_add(
+    bool decoded,
+    const InfraredMessage* message,
+    uint32_t frequency,
+    const uint32_t* timings,
+    size_t timings_size) {
+    uint32_t airtime_us = 0;
+    for(size_t i = 0; i < timings_size; i++) {
+        airtime_us += timings[i];
+    }
+
+    pthread_mutex_lock(&pt_host_tx_mutex);
+    furi_check(pt_host_tx_count < PT_HOST_TRANSMISSIONS);
+    PtHostTransmission* tx = &pt_host_tx_log[pt_host_tx_count++];
+    memset(tx, 0, sizeof(PtHostTransmission));
+    tx->tick = furi_get_tick();
+    tx->pin = pt_host_tx_pin;
+    tx->decoded = decoded;
+    if(message) tx->message = *message;
+    tx->frequency = frequency;
+    tx->timings_size = MIN(timings_size, (size_t)PT_HOST_TX_TIMINGS);
+    memcpy(tx->timings, timings, tx->timings_size * sizeof(uint32_t));
+    pthread_mutex_unlock(&pt_host_tx_mutex);
+    return airtime_us;
+}
+
+static void pt_host_tx_sleep_us(uint32_t microseconds) {
+    struct timespec duration = {
+        .tv_sec = microseconds / 1000000,
+        .tv_nsec = (microseconds % 1000000) * 1000L,
+    };
+    nanosleep(&duration, NULL);
+}
+
+FuriHalInfraredTxPin furi_hal_infrared_detect_tx_output(void) {
+    return pt_host_external ? FuriHalInfraredTxPinExtPA7 : FuriHalInfraredTxPinInternal;
+}
+
+void furi_hal_infrared_set_tx_output(FuriHalInfraredTxPin tx_pin) {
+    furi_check(tx_pin < FuriHalInfraredTxPinMax);
+    pt_host_tx_pin = tx_pin;
+}
+
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context) {
+    pt_host_tx_callback = callback;
+    pt_host_tx_context = context;
+}
+
+// Pulls every timing right away, wait_termination then sleeps out the airtime
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle) {
+    furi_check(pt_host_tx_callback);
+    furi_check(freq >= INFRARED_MIN_FREQUENCY && freq <= INFRARED_MAX_FREQUENCY);
+    furi_check(duty_cycle > 0 && duty_cycle < 1);
+
+    uint32_t timings[PT_HOST_TX_TIMINGS];
+    size_t timings_size = 0;
+    FuriHalInfraredTxGetDataState state;
+    do {
+        uint32_t duration = 0;
+        bool level = false;
+        state = pt_host_tx_callback(pt_host_tx_context, &duration, &level);
+        if(duration && timings_size < PT_HOST_TX_TIMINGS) timings[timings_size++] = duration;
+    } while(state != FuriHalInfraredTxGetDataStateLastDone);
+
+    uint32_t airtime_us = pt_host_tx_log_add(false, NULL, freq, timings, timings_size);
+    pt_host_tx_done_ns = pt_host_now_ns() + airtime_us * 1000ULL;
+}
+
+void furi_hal_infrared_async_tx_wait_termination(void) {
+    uint64_t now = pt_host_now_ns();
+    if(pt_host_tx_done_ns > now) pt_host_tx_sleep_us((pt_host_tx_done_ns - now) / 1000);
+    pt_host_tx_callback = NULL;
+}
+
+void infrared_send(const InfraredMessage* message, int times) {
+    furi_check(infrared_is_protocol_valid(message->protocol) && times > 0);
+    InfraredEncoderHandler* encoder = infrared_alloc_encoder();
+    infrared_reset_encoder(encoder, message);
+
+    uint32_t timings[PT_HOST_TX_TIMINGS];
+    size_t timings_size = 0;
+    for(int frame = 0; frame < times; frame++) {
+        InfraredStatus status;
+        do {
+            uint32_t duration;
+            bool level;
+            status = infrared_encode(encoder, &duration, &level);
+            if(timings_size < PT_HOST_TX_TIMINGS) timings[timings_size++] = duration;
+        } while(status == InfraredStatusOk);
+    }
+    infrared_free_encoder(encoder);
+
+    uint32_t frequency = infrared_get_protocol_frequency(message->protocol);
+    pt_host_tx_sleep_us(pt_host_tx_log_add(true, message, frequency, timings, timings_size));
+}
+
+void infrared_send_raw_ext(
+    const uint32_t* timings,
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle) {
+    furi_check(start_from_mark);
+    furi_check(frequency >= INFRARED_MIN_FREQUENCY && frequency <= INFRARED_MAX_FREQUENCY);
+    furi_check(duty_cycle > 0 && duty_cycle < 1);
+    pt_host_tx_sleep_us(pt_host_tx_log_add(false, NULL, frequency, timings, timings_cnt));
+}
+
+void furi_hal_power_enable_otg(void) {
+    furi_check(!pt_host_otg_on);
+    pt_host_otg_on = true;
+    pt_host_otg_enables++;
+}
+
+void furi_hal_power_disable_otg(void) {
+    furi_check(pt_host_otg_on);
+    pt_host_otg_on = false;
+}
+
+void pt_host_infrared_set_external(bool plugged_in) {
+    pt_host_external = plugged_in;
+}
+
+size_t pt_host_infrared_transmissions(const PtHostTransmission** transmissions) {
+    pthread_mutex_lock(&pt_host_tx_mutex);
+    size_t count = pt_host_tx_count;
+    pthread_mutex_unlock(&pt_host_tx_mutex);
+    *transmissions = pt_host_tx_log;
+    return count;
+}
+
+void pt_host_infrared_reset(void) {
+    pthread_mutex_lock(&pt_host_tx_mutex);
+    pt_host_tx_count = 0;
+    pthread_mutex_unlock(&pt_host_tx_mutex);
+    pt_host_otg_enables = 0;
+}
+
+uint32_t pt_host_power_otg_enabled(void) {
+    return pt_host_otg_enables;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+// Types and constants of the firmware's lib/infrared that the app uses, with the same
+// values. The codecs in infrared.c only know NEC and NECext, every other protocol encodes
+// as a single mark and never decodes.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define INFRARED_COMMON_CARRIER_FREQUENCY ((uint32_t)38000)
+#define INFRARED_COMMON_DUTY_CYCLE        ((float)0.33)
+#define INFRARED_MIN_FREQUENCY            10000
+#define INFRARED_MAX_FREQUENCY            56000
+
+typedef enum {
+    InfraredProtocolUnknown = -1,
+    InfraredProtocolNEC = 0,
+    InfraredProtocolNECext,
+    InfraredProtocolNEC42,
+    InfraredProtocolNEC42ext,
+    InfraredProtocolSamsung32,
+    InfraredProtocolRC6,
+    InfraredProtocolRC5,
+    InfraredProtocolRC5X,
+    InfraredProtocolSIRC,
+    InfraredProtocolSIRC15,
+    InfraredProtocolSIRC20,
+    InfraredProtocolKaseikyo,
+    InfraredProtocolRCA,
+    InfraredProtocolPioneer,
+    InfraredProtocolMAX,
+} InfraredProtocol;
+
+typedef struct {
+    InfraredProtocol protocol;
+    uint32_t address;
+    uint32_t command;
+    bool repeat;
+} InfraredMessage;
+
+typedef enum {
+    InfraredStatusError,
+    InfraredStatusOk,
+    InfraredStatusDone,
+    InfraredStatusReady,
+} InfraredStatus;
+
+typedef struct InfraredDecoderHandler InfraredDecoderHandler;
+typedef struct InfraredEncoderHandler InfraredEncoderHandler;
+
+InfraredProtocol infrared_get_protocol_by_name(const char* protocol_name);
+const char* infrared_get_protocol_name(InfraredProtocol protocol);
+bool infrared_is_protocol_valid(InfraredProtocol protocol);
+uint32_t infrared_get_protocol_frequency(InfraredProtocol protocol);
+float infrared_get_protocol_duty_cycle(InfraredProtocol protocol);
+size_t infrared_get_protocol_min_repeat_count(InfraredProtocol protocol);
+
+InfraredDecoderHandler* infrared_alloc_decoder(void);
+void infrared_free_decoder(InfraredDecoderHandler* handler);
+void infrared_reset_decoder(InfraredDecoderHandler* handler);
+const InfraredMessage*
+    infrared_decode(InfraredDecoderHandler* handler, bool level, uint32_t duration);
+const InfraredMessage* infrared_check_decoder_ready(InfraredDecoderHandler* handler);
+
+InfraredEncoderHandler* infrared_alloc_encoder(void);
+void infrared_free_encoder(InfraredEncoderHandler* handler);
+void infrared_reset_encoder(InfraredEncoderHandler* handler, const InfraredMessage* message);
+InfraredStatus infrared_encode(InfraredEncoderHandler* handler, uint32_t* duration, bool* level);
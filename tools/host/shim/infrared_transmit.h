@@ -0,0 +1,14 @@
+#pragma once
+
+// Blocking sends, they take as long as the signal is on air and are logged like the
+// asynchronous transmitter's
+
+#include <infrared.h>
+
+void infrared_send(const InfraredMessage* message, int times);
+void infrared_send_raw_ext(
+    const uint32_t* timings,
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle);
@@ -0,0 +1,31 @@
+#pragma once
+
+// The receiver runs its own thread, and captures handed to pt_host_infrared_receive come
+// out of it through the received signal callback
+
+#include <infrared.h>
+
+typedef struct InfraredWorker InfraredWorker;
+typedef struct InfraredWorkerSignal InfraredWorkerSignal;
+
+typedef void (*InfraredWorkerReceivedSignalCallback)(
+    void* context,
+    InfraredWorkerSignal* received_signal);
+
+InfraredWorker* infrared_worker_alloc(void);
+void infrared_worker_free(InfraredWorker* instance);
+void infrared_worker_rx_start(InfraredWorker* instance);
+void infrared_worker_rx_stop(InfraredWorker* instance);
+void infrared_worker_rx_set_received_signal_callback(
+    InfraredWorker* instance,
+    InfraredWorkerReceivedSignalCallback callback,
+    void* context);
+void infrared_worker_rx_enable_blink_on_receiving(InfraredWorker* instance, bool enable);
+void infrared_worker_rx_enable_signal_decoding(InfraredWorker* instance, bool enable);
+
+bool infrared_worker_signal_is_decoded(const InfraredWorkerSignal* signal);
+void infrared_worker_get_raw_signal(
+    const InfraredWorkerSignal* signal,
+    const uint32_t** timings,
+    size_t* timings_cnt);
+const InfraredMessage* infrared_worker_get_decoded_signal(const InfraredWorkerSignal* signal);
@@ -0,0 +1,33 @@
+#pragma once
+
+// Input events as the input service publishes them, same values as the firmware so a
+// replay recorded on a Flipper plays back here
+
+#include <furi.h>
+
+#define RECORD_INPUT_EVENTS "input_events"
+
+typedef enum {
+    InputKeyUp,
+    InputKeyDown,
+    InputKeyRight,
+    InputKeyLeft,
+    InputKeyOk,
+    InputKeyBack,
+    InputKeyMAX,
+} InputKey;
+
+typedef enum {
+    InputTypePress,
+    InputTypeRelease,
+    InputTypeShort,
+    InputTypeLong,
+    InputTypeRepeat,
+    InputTypeMAX,
+} InputType;
+
+typedef struct {
+    uint32_t sequence;
+    InputKey key;
+    InputType type;
+} InputEvent;
@@ -0,0 +1,33 @@
+#pragma once
+
+// Sequences are only counted, see pt_host_notification_count
+
+#include <furi.h>
+
+#define RECORD_NOTIFICATION "notification"
+
+typedef struct {
+    const char* name;
+} NotificationMessage;
+
+typedef const NotificationMessage* NotificationSequence[];
+typedef struct NotificationApp NotificationApp;
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
+
+extern const NotificationMessage message_vibro_on;
+extern const NotificationMessage message_vibro_off;
+extern const NotificationMessage message_green_255;
+extern const NotificationMessage message_green_0;
+extern const NotificationMessage message_blue_255;
+extern const NotificationMessage message_blue_0;
+extern const NotificationMessage message_red_255;
+extern const NotificationMessage message_red_0;
+extern const NotificationMessage message_delay_10;
+extern const NotificationMessage message_delay_100;
+
+extern const NotificationSequence sequence_blink_green_10;
+extern const NotificationSequence sequence_blink_green_100;
+extern const NotificationSequence sequence_blink_red_10;
+extern const NotificationSequence sequence_success;
+extern const NotificationSequence sequence_error;
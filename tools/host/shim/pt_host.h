@@ -0,0 +1,108 @@
+#pragma once
+
+// What the host harness can do that firmware code can't: inject input and IR captures,
+// read back what the app transmitted and played, and the counters behind `make bench`.
+
+#include <furi.h>
+#include <infrared.h>
+#include <furi_hal_infrared.h>
+#include <notification/notification_messages.h>
+
+// Log lines at or above this level go to stderr, 'N' (the default) prints none. The
+// PT_HOST_LOG environment variable sets it at startup, e.g. PT_HOST_LOG=D.
+void pt_host_set_log_level(char level);
+
+// Time
+
+uint64_t pt_host_now_ns(void);
+
+// Records and storage. EXT_PATH files live under root, other paths are plain host paths.
+
+void pt_host_services_start(const char* storage_root);
+void pt_host_services_stop(void);
+// The GUI part of the above, in gui.c
+void pt_host_gui_start(void);
+void pt_host_gui_stop(void);
+// Path of an EXT_PATH file on the host, in a static buffer
+const char* pt_host_storage_path(const char* path);
+
+// Heap, allocations made by the calling thread since it started
+uint32_t pt_host_thread_allocs(void);
+size_t pt_host_heap_used(void);
+
+// Stacks are painted like FreeRTOS does, so the free space reported is a real high-water
+// mark. Every host stack is PT_HOST_STACK_EXTRA bigger than asked for, x86-64 frames and
+// glibc's printf need much more than a Cortex-M4, so only compare them between host runs.
+#define PT_HOST_STACK_EXTRA (64 * 1024)
+
+// Timer callbacks, per callback function
+
+typedef struct {
+    const char* name;
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} PtHostTimerStats;
+
+size_t pt_host_timer_stats(const PtHostTimerStats** stats);
+
+// GUI. Views are named by the harness after their dispatcher id.
+
+typedef struct {
+    uint32_t frames;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t allocs; // malloc calls made from inside the draw callback
+} PtHostDrawStats;
+
+typedef struct {
+    uint32_t events;
+    uint32_t updates; // Events that changed a model before they were done
+    uint64_t update_total_ns; // From publishing the event to the first model update
+    uint64_t update_max_ns;
+    uint64_t handled_total_ns; // From publishing the event to the app being done with it
+    uint64_t handled_max_ns;
+} PtHostInputStats;
+
+#define PT_HOST_VIEW_IDS 8
+
+const PtHostDrawStats* pt_host_draw_stats(uint32_t view_id);
+const PtHostInputStats* pt_host_input_stats(void);
+void pt_host_gui_reset_stats(void);
+// Id of the view on screen, VIEW_NONE while no dispatcher is attached
+uint32_t pt_host_gui_current_view(void);
+// Last frame as 64 rows of text, '#' for a set pixel
+void pt_host_gui_dump(FILE* stream);
+
+// Dialogs, the file browser returns this path, NULL closes it without a pick
+
+void pt_host_dialogs_set_file(const char* path);
+
+// Notifications
+
+uint32_t pt_host_notification_count(const NotificationSequence* sequence);
+// Sequences played that contain this message, e.g. message_blue_255 for a fire
+uint32_t pt_host_notification_count_with(const NotificationMessage* message);
+void pt_host_notification_reset(void);
+
+// Infrared. A capture handed to receive goes to the worker that is receiving, if any,
+// decoded when the NEC stand-in decoder takes it from its first timing.
+
+bool pt_host_infrared_receive(const uint32_t* timings, size_t timings_size);
+void pt_host_infrared_set_external(bool plugged_in);
+
+#define PT_HOST_TX_TIMINGS 512
+
+typedef struct {
+    uint32_t tick;
+    FuriHalInfraredTxPin pin;
+    bool decoded;
+    InfraredMessage message;
+    uint32_t frequency;
+    size_t timings_size;
+    uint32_t timings[PT_HOST_TX_TIMINGS];
+} PtHostTransmission;
+
+size_t pt_host_infrared_transmissions(const PtHostTransmission** transmissions);
+void pt_host_infrared_reset(void);
+uint32_t pt_host_power_otg_enabled(void);
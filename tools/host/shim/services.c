@@ -0,0 +1,411 @@
+// Only built by tools/host/Makefile, the app build picks up every .c in the tree
+#ifdef PT_HOST_TEST
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <pt_host.h>
+#include <input/input.h>
+#include <storage/storage.h>
+#include <dialogs/dialogs.h>
+#include <notification/notification_messages.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define PT_HOST_PATH_SIZE 512
+#define PT_HOST_SEQUENCES 32
+
+// Storage
+
+static char pt_host_storage_root[PT_HOST_PATH_SIZE];
+
+static void pt_host_storage_map(const char* path, char* host_path) {
+    const char* ext = EXT_PATH("");
+    if(strncmp(path, ext, strlen(ext)) == 0) {
+        furi_check(pt_host_storage_root[0]);
+        snprintf(
+            host_path, PT_HOST_PATH_SIZE, "%s/%s", pt_host_storage_root, path + strlen(ext));
+    } else {
+        strlcpy(host_path, path, PT_HOST_PATH_SIZE);
+    }
+}
+
+const char* pt_host_storage_path(const char* path) {
+    static char host_path[PT_HOST_PATH_SIZE];
+    pt_host_storage_map(path, host_path);
+    return host_path;
+}
+
+// The firmware creates app data folders on demand, the host does it for every write
+static void pt_host_storage_mkdirs(const char* host_path) {
+    char directory[PT_HOST_PATH_SIZE];
+    strlcpy(directory, host_path, sizeof(directory));
+    for(char* slash = strchr(directory + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        furi_check(mkdir(directory, 0755) == 0 || errno == EEXIST);
+        *slash = '/';
+    }
+}
+
+struct File {
+    FILE* stream;
+};
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return malloc(sizeof(File));
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode) {
+    furi_check(!file->stream);
+    char host_path[PT_HOST_PATH_SIZE];
+    pt_host_storage_map(path, host_path);
+
+    if(access & FSAM_WRITE) pt_host_storage_mkdirs(host_path);
+    struct stat info;
+    bool exists = stat(host_path, &info) == 0;
+    const char* flags = NULL;
+    switch(mode) {
+    case FSOM_OPEN_EXISTING:
+        if(exists) flags = access == FSAM_READ ? "rb" : "r+b";
+        break;
+    case FSOM_OPEN_ALWAYS:
+        flags = access == FSAM_READ ? "rb" : exists ? "r+b" : "w+b";
+        break;
+    case FSOM_OPEN_APPEND:
+        flags = access == FSAM_READ ? "rb" : "a+b";
+        break;
+    case FSOM_CREATE_NEW:
+        if(!exists) flags = "w+b";
+        break;
+    case FSOM_CREATE_ALWAYS:
+        flags = "w+b";
+        break;
+    }
+    if(flags) file->stream = fopen(host_path, flags);
+    return file->stream != NULL;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    if(!file->stream) return 0;
+    return fread(buff, 1, bytes_to_read, file->stream);
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    if(!file->stream) return 0;
+    return fwrite(buff, 1, bytes_to_write, file->stream);
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->stream) return 0;
+    struct stat info;
+    fflush(file->stream);
+    if(fstat(fileno(file->stream), &info) != 0) return 0;
+    return info.st_size;
+}
+
+bool storage_file_close(File* file) {
+    bool closed = file->stream && fclose(file->stream) == 0;
+    file->stream = NULL;
+    return closed;
+}
+
+void storage_file_free(File* file) {
+    if(file->stream) storage_file_close(file);
+    free(file);
+}
+
+// Notifications
+
+const NotificationMessage message_vibro_on = {"vibro_on"};
+const NotificationMessage message_vibro_off = {"vibro_off"};
+const NotificationMessage message_green_255 = {"green_255"};
+const NotificationMessage message_green_0 = {"green_0"};
+const NotificationMessage message_blue_255 = {"blue_255"};
+const NotificationMessage message_blue_0 = {"blue_0"};
+const NotificationMessage message_red_255 = {"red_255"};
+const NotificationMessage message_red_0 = {"red_0"};
+const NotificationMessage message_delay_10 = {"delay_10"};
+const NotificationMessage message_delay_100 = {"delay_100"};
+
+const NotificationSequence sequence_blink_green_10 = {
+    &message_green_255,
+    &message_delay_10,
+    &message_green_0,
+    NULL,
+};
+const NotificationSequence sequence_blink_green_100 = {
+    &message_green_255,
+    &message_delay_100,
+    &message_green_0,
+    NULL,
+};
+const NotificationSequence sequence_blink_red_10 = {
+    &message_red_255,
+    &message_delay_10,
+    &message_red_0,
+    NULL,
+};
+const NotificationSequence sequence_success = {
+    &message_green_255,
+    &message_vibro_on,
+    &message_delay_100,
+    &message_vibro_off,
+    &message_green_0,
+    NULL,
+};
+const NotificationSequence sequence_error = {
+    &message_red_255,
+    &message_vibro_on,
+    &message_delay_100,
+    &message_vibro_off,
+    &message_red_0,
+    NULL,
+};
+
+typedef struct {
+    const NotificationSequence* sequence;
+    uint32_t count;
+} PtHostPlayed;
+
+struct NotificationApp {
+    pthread_mutex_t mutex;
+    PtHostPlayed played[PT_HOST_SEQUENCES];
+};
+
+static NotificationApp pt_host_notification = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    pthread_mutex_lock(&app->mutex);
+    PtHostPlayed* played = NULL;
+    for(size_t i = 0; i < PT_HOST_SEQUENCES && !played; i++) {
+        if(!app->played[i].sequence || app->played[i].sequence == sequence) {
+            played = &app->played[i];
+        }
+    }
+    furi_check(played);
+    played->sequence = sequence;
+    played->count++;
+    pthread_mutex_unlock(&app->mutex);
+}
+
+uint32_t pt_host_notification_count(const NotificationSequence* sequence) {
+    NotificationApp* app = &pt_host_notification;
+    uint32_t count = 0;
+    pthread_mutex_lock(&app->mutex);
+    for(size_t i = 0; i < PT_HOST_SEQUENCES; i++) {
+        if(app->played[i].sequence == sequence) count = app->played[i].count;
+    }
+    pthread_mutex_unlock(&app->mutex);
+    return count;
+}
+
+uint32_t pt_host_notification_count_with(const NotificationMessage* message) {
+    NotificationApp* app = &pt_host_notification;
+    uint32_t count = 0;
+    pthread_mutex_lock(&app->mutex);
+    for(size_t i = 0; i < PT_HOST_SEQUENCES && app->played[i].sequence; i++) {
+        for(const NotificationMessage* const* m = *app->played[i].sequence; *m; m++) {
+            if(*m == message) {
+                count += app->played[i].count;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&app->mutex);
+    return count;
+}
+
+void pt_host_notification_reset(void) {
+    NotificationApp* app = &pt_host_notification;
+    pthread_mutex_lock(&app->mutex);
+    memset(app->played, 0, sizeof(app->played));
+    pthread_mutex_unlock(&app->mutex);
+}
+
+// Dialogs
+
+struct DialogsApp {
+    pthread_mutex_t mutex;
+    char file[PT_HOST_PATH_SIZE];
+    bool has_file;
+};
+
+static DialogsApp pt_host_dialogs = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+void pt_host_dialogs_set_file(const char* path) {
+    pthread_mutex_lock(&pt_host_dialogs.mutex);
+    pt_host_dialogs.has_file = path != NULL;
+    if(path) strlcpy(pt_host_dialogs.file, path, sizeof(pt_host_dialogs.file));
+    pthread_mutex_unlock(&pt_host_dialogs.mutex);
+}
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon) {
+    memset(options, 0, sizeof(DialogsFileBrowserOptions));
+    options->extension = extension;
+    options->icon = icon;
+    options->skip_assets = true;
+    options->hide_dot_files = true;
+}
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options) {
+    UNUSED(path);
+    UNUSED(options);
+    pthread_mutex_lock(&context->mutex);
+    bool picked = context->has_file;
+    if(picked) furi_string_set(result_path, context->file);
+    pthread_mutex_unlock(&context->mutex);
+    return picked;
+}
+
+struct DialogMessage {
+    const char* header;
+    const char* text;
+};
+
+DialogMessage* dialog_message_alloc(void) {
+    return malloc(sizeof(DialogMessage));
+}
+
+void dialog_message_free(DialogMessage* message) {
+    free(message);
+}
+
+void dialog_message_set_header(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    message->header = text;
+}
+
+void dialog_message_set_text(
+    DialogMessage* message,
+    const char* text,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    message->text = text;
+}
+
+void dialog_message_set_buttons(
+    DialogMessage* message,
+    const char* left,
+    const char* center,
+    const char* right) {
+    UNUSED(message);
+    UNUSED(left);
+    UNUSED(center);
+    UNUSED(right);
+}
+
+DialogMessageButton dialog_message_show(DialogsApp* context, const DialogMessage* message) {
+    UNUSED(context);
+    fprintf(
+        stderr,
+        "dialog: %s: %s\n",
+        message->header ? message->header : "",
+        message->text ? message->text : "");
+    return DialogMessageButtonCenter;
+}
+
+// RTC
+
+uint32_t datetime_datetime_to_timestamp(DateTime* datetime) {
+    struct tm time = {
+        .tm_year = datetime->year - 1900,
+        .tm_mon = datetime->month - 1,
+        .tm_mday = datetime->day,
+        .tm_hour = datetime->hour,
+        .tm_min = datetime->minute,
+        .tm_sec = datetime->second,
+    };
+    return timegm(&time);
+}
+
+void datetime_timestamp_to_datetime(uint32_t timestamp, DateTime* datetime) {
+    time_t seconds = timestamp;
+    struct tm time;
+    gmtime_r(&seconds, &time);
+    datetime->year = time.tm_year + 1900;
+    datetime->month = time.tm_mon + 1;
+    datetime->day = time.tm_mday;
+    datetime->hour = time.tm_hour;
+    datetime->minute = time.tm_min;
+    datetime->second = time.tm_sec;
+    // The firmware counts Monday as 1 and Sunday as 7
+    datetime->weekday = time.tm_wday ? time.tm_wday : 7;
+}
+
+void furi_hal_rtc_get_datetime(DateTime* datetime) {
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    datetime_timestamp_to_datetime(timegm(&local), datetime);
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    DateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    return datetime_datetime_to_timestamp(&datetime);
+}
+
+// Cycle counter
+
+#define PT_HOST_CPU_MHZ 64
+
+PtHostDwt* pt_host_dwt(void) {
+    // Per thread, each caller only reads CYCCNT right after this refreshed it
+    static __thread PtHostDwt dwt;
+    dwt.CYCCNT = pt_host_now_ns() * PT_HOST_CPU_MHZ / 1000;
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return PT_HOST_CPU_MHZ;
+}
+
+// Records
+
+static FuriPubSub* pt_host_input_events = NULL;
+
+void pt_host_services_start(const char* storage_root) {
+    strlcpy(pt_host_storage_root, storage_root, sizeof(pt_host_storage_root));
+    pt_host_input_events = furi_pubsub_alloc();
+    furi_record_create(RECORD_INPUT_EVENTS, pt_host_input_events);
+    furi_record_create(RECORD_STORAGE, &pt_host_storage_root);
+    furi_record_create(RECORD_NOTIFICATION, &pt_host_notification);
+    furi_record_create(RECORD_DIALOGS, &pt_host_dialogs);
+    pt_host_gui_start();
+}
+
+void pt_host_services_stop(void) {
+    pt_host_gui_stop();
+    furi_record_create(RECORD_DIALOGS, NULL);
+    furi_record_create(RECORD_NOTIFICATION, NULL);
+    furi_record_create(RECORD_STORAGE, NULL);
+    furi_record_create(RECORD_INPUT_EVENTS, NULL);
+    furi_pubsub_free(pt_host_input_events);
+    pt_host_input_events = NULL;
+}
+
+#endif
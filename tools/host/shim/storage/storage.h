@@ -0,0 +1,35 @@
+#pragma once
+
+// The file API on top of stdio. EXT_PATH files live under the root the harness gives
+// pt_host_services_start, any other path is a plain host path.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECORD_STORAGE "storage"
+
+typedef struct Storage Storage;
+typedef struct File File;
+
+typedef enum {
+    FSAM_READ = (1 << 0),
+    FSAM_WRITE = (1 << 1),
+    FSAM_READ_WRITE = FSAM_READ | FSAM_WRITE,
+} FS_AccessMode;
+
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+File* storage_file_alloc(Storage* storage);
+bool storage_file_open(File* file, const char* path, FS_AccessMode access, FS_OpenMode mode);
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read);
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write);
+uint64_t storage_file_size(File* file);
+bool storage_file_close(File* file);
+void storage_file_free(File* file);
@@ -2,4 +2,5 @@ typedef enum {
     PTViewTimeInput,
     PTViewCountdown,
     PTViewIrLearn,
+    PTViewSubmenu,
 } PTView;
\ No newline at end of file
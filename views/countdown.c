@@ -3,16 +3,78 @@
 #include <gui/elements.h>
 #include <furi.h>
 #include <furi_hal.h>
-#include <furi_hal_power.h>
-#include <infrared_transmit.h>
+#include <furi_hal_rtc.h>
+#include <datetime/datetime.h>
 #include <gui/scene_manager.h>
+#include "../helpers/lock_stats.h"
+#include "../helpers/input_replay.h"
+#include "../helpers/pt_trace.h"
+#include "../helpers/pt_profile.h"
+#include "../helpers/stack_stats.h"
+#include "../helpers/timer_latency.h"
+#include "../helpers/size_budget.h"
 
 #define TAG "PT"
 
+#define COUNTDOWN_TICK_MS 1000
+// The display only wakes up when what it shows changes. Above COARSE_MS that is whole
+// minutes, below FINE_MS tenths of a second, and whole seconds in between.
+#define COUNTDOWN_COARSE_MS      (5 * 60 * 1000)
+#define COUNTDOWN_FINE_MS        (10 * 1000)
+#define COUNTDOWN_COARSE_STEP_MS (60 * 1000)
+#define COUNTDOWN_FINE_STEP_MS   100
+// Never arm the final fire more than this far ahead, whatever the estimate says
+#define COUNTDOWN_MAX_LEAD_MS 100
+// How often a wall clock countdown compares its deadline against the RTC, and how far
+// apart they have to be before it is corrected (the RTC only has whole seconds)
+#define COUNTDOWN_RTC_CHECK_S  30
+#define COUNTDOWN_RTC_DRIFT_MS 1500
+// Fires waiting for the fire thread, a second one only queues up when an interval is
+// shorter than the macro it sends
+#define COUNTDOWN_FIRE_QUEUE_SIZE 2
+
+// One deadline for the fire thread to send. Everything it needs is taken when the timer
+// goes off, so the thread never reads state the timer callback is still changing.
+typedef struct {
+    uint32_t deadline_tick;
+    uint32_t cycle;
+    uint32_t missed;
+    bool send_ir;
+    uint32_t generation; // Fires posted before the last cancel are dropped
+    bool record_jitter; // Interval mode, the fire goes into the jitter stats
+    bool stop; // Ends the thread
+} CountdownFire;
+
 struct CountdownUtils {
     View* view;
     FuriTimer* timer;
+    FuriTimer* fire_timer;
+    // A macro timeline sleeps between its steps for seconds, which the timer service
+    // must never do, so the timer callbacks hand fires to this thread
+    FuriThread* fire_thread;
+    FuriMessageQueue* fire_queue;
+    // Released to end the macro being sent, generation drops the fires still queued
+    FuriSemaphore* fire_cancel;
+    volatile uint32_t fire_generation;
+    IrMacro fire_macro; // Only touched by the fire thread
     PauseTimerApp* app;
+    uint32_t start_tick;
+    uint32_t start_time; // RTC timestamp matching start_tick, for the fire journal
+    uint32_t deadline_tick;
+    uint32_t period_ticks;
+    uint32_t cycle; // Index k of the pending deadline, start + k * period
+    bool repeat;
+    uint32_t fire_at;
+    bool fire_armed;
+    uint32_t fire_expected_tick;
+    volatile bool ticking; // Cleared before the display timer is stopped
+    uint32_t tick_expected_tick;
+    uint32_t rtc_check_tick;
+    TimerLatency latency;
+    struct CountdownModel* model;
+    FuriMutex* write_mutex;
+    LockStats lock_stats;
+    uint32_t lock_start;
 };
 
 typedef enum {
@@ -20,147 +82,564 @@ typedef enum {
     CountdownState_Complete
 } CountdownState;
 
+// Copied whole on every draw and every seqlock retry, so the byte sized fields go last
 typedef struct {
-    uint16_t total_seconds;
-    uint16_t remaining_seconds;
-    CountdownState state;
+    uint32_t total_seconds;
+    uint32_t remaining_ms;
+    uint32_t fire_count;
+    uint32_t missed_count;
+    int32_t last_jitter_ms;
+    int32_t max_jitter_ms;
+    uint16_t dead_time_us; // Gap between the two outputs of the last dual output fire
+    uint8_t state; // CountdownState
+    uint8_t fire_hour;
+    uint8_t fire_minute;
+    bool wall_clock;
     bool has_ir_signal;
     bool ir_sent;
+    bool repeat;
+    bool dual_output;
+} CountdownSnapshot;
+
+PT_SIZE_BUDGET(CountdownSnapshot, 36);
+
+// The view model is lock free, writers bump the sequence to an odd value while they
+// update the snapshot so the draw callback can detect and retry a torn read instead
+// of ever blocking the timer thread
+typedef struct CountdownModel {
+    volatile uint32_t sequence;
+    CountdownSnapshot snapshot;
 } CountdownModel;
 
-static void transmit_ir_signal(PauseTimerApp* app) {
-    if(!app || !app->learned_ir_signal.has_signal) {
+static void countdown_model_read(CountdownModel* model, CountdownSnapshot* out) {
+    uint32_t start, end;
+    do {
+        start = __atomic_load_n(&model->sequence, __ATOMIC_ACQUIRE);
+        memcpy(out, (const void*)&model->snapshot, sizeof(CountdownSnapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&model->sequence, __ATOMIC_RELAXED);
+    } while((start & 1) || start != end);
+}
+
+// Writers only ever contend with each other, never with the draw callback
+static CountdownSnapshot* countdown_model_write_begin(CountdownUtils* countdown) {
+    furi_check(furi_mutex_acquire(countdown->write_mutex, FuriWaitForever) == FuriStatusOk);
+    __atomic_fetch_add(&countdown->model->sequence, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    countdown->lock_start = lock_stats_begin();
+    return &countdown->model->snapshot;
+}
+
+static void countdown_model_write_end(CountdownUtils* countdown, bool update) {
+    __atomic_fetch_add(&countdown->model->sequence, 1, __ATOMIC_RELEASE);
+    lock_stats_end(&countdown->lock_stats, countdown->lock_start);
+    furi_mutex_release(countdown->write_mutex);
+    if(update) {
+        view_commit_model(countdown->view, true);
+    }
+}
+
+#define with_countdown_model(countdown, type, code, update) \
+    {                                                        \
+        type = countdown_model_write_begin(countdown);       \
+        {code};                                              \
+        countdown_model_write_end(countdown, update);        \
+    }
+
+// Fire the whole macro timeline relative to the given deadline
+static void
+    countdown_fire(CountdownUtils* countdown, uint32_t deadline_tick, IrMacroFireReport* report) {
+    if(!countdown->app) {
         FURI_LOG_W(TAG, "No IR signal to transmit");
         return;
     }
-    FURI_LOG_I(TAG, "Transmitting IR signal...");
+    // Background analysis may upgrade a step while the macro is sending, so the fire
+    // thread sends a copy taken under the bank mutex
+    IrBank* bank = &countdown->app->bank;
+    ir_bank_copy_macro(bank, bank->selected, &countdown->fire_macro);
+    ir_macro_execute(
+        &countdown->fire_macro,
+        deadline_tick,
+        countdown->app->dual_output,
+        countdown->fire_cancel,
+        report);
+
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
+        {
+            model->dual_output = report->dual_output;
+            model->dead_time_us = report->dead_time_us;
+        },
+        true);
+}
 
-    // Detect external module and configure accordingly
-    FuriHalInfraredTxPin output_pin = furi_hal_infrared_detect_tx_output();
-    bool using_external = (output_pin == FuriHalInfraredTxPinExtPA7);
+static void countdown_feedback(CountdownUtils* countdown, PtFeedbackEvent event) {
+    if(countdown->app) pt_feedback_play(countdown->app->feedback, event);
+}
 
-    if (using_external) {
-        furi_hal_power_enable_otg();
+// Only queues the record, the journal thread does the SD writes later
+static void countdown_journal_fire(
+    CountdownUtils* countdown,
+    uint32_t deadline_tick,
+    uint32_t cycle,
+    uint32_t missed,
+    const IrMacroFireReport* report) {
+    if(!countdown->app) return;
+    IrBank* bank = &countdown->app->bank;
+    const IrMacro* macro = ir_bank_selected_macro(bank);
+
+    FireJournalRecord record = {
+        .start_time = countdown->start_time,
+        .deadline_tick = deadline_tick,
+        .fire_tick = report->sent ? report->first_tick : furi_get_tick(),
+        .signal_id = macro->count ? macro->steps[0].signal.fingerprint : 0,
+        .cycle = MIN(cycle, UINT16_MAX),
+        .slot = bank->selected,
+        .output_pin = report->dual_output ? FIRE_JOURNAL_PIN_BOTH : report->output_pin,
+        .sent = report->sent,
+    };
+    if(!report->sent) {
+        record.outcome = FireJournalOutcomeNoSignal;
+    } else if(missed) {
+        record.outcome = FireJournalOutcomeMissed;
+    } else {
+        record.outcome = FireJournalOutcomeSent;
     }
 
-    furi_hal_infrared_set_tx_output(output_pin);
+    fire_journal_append(countdown->app->journal, &record);
+}
+
+// Deadlines are always derived from the start tick so that interval mode never
+// accumulates the lateness of earlier cycles
+static void countdown_arm(
+    CountdownUtils* countdown,
+    uint32_t start_tick,
+    uint32_t total_seconds,
+    bool repeat) {
+    countdown->start_tick = start_tick;
+    countdown->start_time = furi_hal_rtc_get_timestamp();
+    countdown->period_ticks = furi_ms_to_ticks(total_seconds * 1000);
+    countdown->cycle = 1;
+    countdown->deadline_tick = countdown->start_tick + countdown->period_ticks;
+    countdown->repeat = repeat && total_seconds > 0;
+    countdown->fire_armed = false;
+}
+
+static uint32_t countdown_ticks_past(uint32_t now, uint32_t target) {
+    int32_t late = (int32_t)(now - target);
+    return late > 0 ? late : 0;
+}
+
+// The display tick is too coarse and too late to fire from, so once the deadline is
+// within one tick we arm a one shot timer for it instead. It is started early by the
+// latency the timer service has been showing, ir_macro_execute then waits out whatever
+// is left so the first IR edge lands on the deadline itself.
+static void countdown_schedule_fire(CountdownUtils* countdown, uint32_t now) {
+    if(countdown->fire_armed) return;
+
+    uint32_t lead = MIN(
+        timer_latency_percentile(&countdown->latency, 95),
+        furi_ms_to_ticks(COUNTDOWN_MAX_LEAD_MS));
+    int32_t remaining = (int32_t)(countdown->deadline_tick - now);
+    if(remaining > (int32_t)(furi_ms_to_ticks(COUNTDOWN_TICK_MS) + lead)) return;
+
+    uint32_t delay = MAX(remaining - (int32_t)lead, 1);
+    countdown->fire_armed = true;
+    countdown->fire_expected_tick = now + delay;
+    furi_timer_start(countdown->fire_timer, delay);
+}
 
-    // Figure out if it's raw or decoded and send it accordingly
-    if(app->learned_ir_signal.is_decoded) {
-        infrared_send(&app->learned_ir_signal.decoded_message, 1);
-    } else if(app->learned_ir_signal.raw_timings) {
-        infrared_send_raw(
-            app->learned_ir_signal.raw_timings, app->learned_ir_signal.raw_timings_size, true);
+static uint32_t countdown_remaining_ms(CountdownUtils* countdown, uint32_t now) {
+    int32_t remaining_ticks = (int32_t)(countdown->deadline_tick - now);
+    if(remaining_ticks <= 0) return 0;
+    return (uint64_t)remaining_ticks * 1000 / furi_kernel_get_tick_frequency();
+}
+
+static uint32_t countdown_display_step_ms(uint32_t remaining_ms) {
+    if(remaining_ms > COUNTDOWN_COARSE_MS) return COUNTDOWN_COARSE_STEP_MS;
+    if(remaining_ms > COUNTDOWN_FINE_MS) return COUNTDOWN_TICK_MS;
+    return COUNTDOWN_FINE_STEP_MS;
+}
+
+// Wake the display exactly when the rounded up readout changes, counted back from the
+// deadline rather than forward from the last wake so it never drifts
+static void countdown_schedule_tick(CountdownUtils* countdown, uint32_t now) {
+    if(!countdown->ticking) return;
+
+    uint32_t remaining_ms = countdown_remaining_ms(countdown, now);
+    uint32_t wait_ms = COUNTDOWN_FINE_STEP_MS;
+    if(remaining_ms > 0) {
+        wait_ms = (remaining_ms - 1) % countdown_display_step_ms(remaining_ms) + 1;
     }
-    furi_delay_ms(100);
 
-    // Cleanup: Reset to internal and disable power if external
-    if (using_external) {
-        furi_hal_power_disable_otg();
+    uint32_t wait = furi_ms_to_ticks(wait_ms);
+    if(!wait) wait = 1;
+    countdown->tick_expected_tick = now + wait;
+    furi_timer_start(countdown->timer, wait);
+}
+
+static void countdown_start_ticking(CountdownUtils* countdown) {
+    uint32_t now = furi_get_tick();
+    countdown->ticking = true;
+    countdown->rtc_check_tick = now;
+    countdown_schedule_tick(countdown, now);
+    countdown_schedule_fire(countdown, now);
+    countdown_feedback(countdown, PtFeedbackArmed);
+}
+
+static void countdown_stop_ticking(CountdownUtils* countdown) {
+    countdown->ticking = false;
+    furi_timer_stop(countdown->timer);
+}
+
+// Readouts are rounded up so the display only reaches zero once the deadline has passed
+static void countdown_draw_remaining(
+    Canvas* canvas,
+    uint32_t remaining_ms,
+    char* timer_str,
+    size_t timer_str_size) {
+
+    if(remaining_ms > COUNTDOWN_COARSE_MS) {
+        // Far from the deadline the exact second doesn't matter, show "~47 min" or "~7h 59m"
+        uint32_t minutes =
+            (remaining_ms + COUNTDOWN_COARSE_STEP_MS - 1) / COUNTDOWN_COARSE_STEP_MS;
+        char minutes_str[4];
+        const char* labels[] = {"~", "h ", "m"};
+        const char* numbers[] = {timer_str, minutes_str};
+        size_t fields = 2;
+        if(minutes >= 60) {
+            snprintf(timer_str, timer_str_size, "%lu", minutes / 60);
+            snprintf(minutes_str, sizeof(minutes_str), "%02lu", minutes % 60);
+        } else {
+            snprintf(timer_str, timer_str_size, "%lu", minutes);
+            labels[1] = " min";
+            fields = 1;
+        }
+
+        // Numbers in the big font, each followed by its unit in the primary one
+        uint16_t widths[5];
+        int32_t x = canvas_width(canvas);
+        for(size_t i = 0; i < fields * 2 + 1; i++) {
+            canvas_set_font(canvas, i % 2 ? FontBigNumbers : FontPrimary);
+            widths[i] = canvas_string_width(canvas, i % 2 ? numbers[i / 2] : labels[i / 2]);
+            x -= widths[i];
+        }
+        x /= 2;
+        for(size_t i = 0; i < fields * 2 + 1; i++) {
+            canvas_set_font(canvas, i % 2 ? FontBigNumbers : FontPrimary);
+            canvas_draw_str(canvas, x, 42, i % 2 ? numbers[i / 2] : labels[i / 2]);
+            x += widths[i];
+        }
+        return;
+    }
+
+    if(remaining_ms > COUNTDOWN_FINE_MS) {
+        // Calculate from the time value minutes and seconds
+        uint32_t seconds = (remaining_ms + 999) / 1000;
+        snprintf(timer_str, timer_str_size, "%02lu:%02lu", seconds / 60, seconds % 60);
+    } else {
+        uint32_t tenths = (remaining_ms + 99) / 100;
+        snprintf(timer_str, timer_str_size, "%02lu.%lu", tenths / 10, tenths % 10);
     }
-    furi_hal_infrared_set_tx_output(FuriHalInfraredTxPinInternal);
+
+    canvas_set_font(canvas, FontBigNumbers);
+    elements_multiline_text_aligned(canvas, 64, 35, AlignCenter, AlignCenter, timer_str);
 }
 
 static void countdown_draw_callback(Canvas* canvas, void* context) {
     furi_assert(context);
-    CountdownModel* model = context;
+    uint32_t profile_start = pt_profile_begin();
+    CountdownSnapshot snapshot;
+    countdown_model_read(context, &snapshot);
+    const CountdownSnapshot* model = &snapshot;
+    input_replay_draw();
+
+    // Draw runs on the GUI thread every app shares, so all the text goes through one buffer
+    char text[32];
 
     canvas_clear(canvas);
     canvas_set_font(canvas, FontPrimary);
 
     if(model->state == CountdownState_Running) {
-        elements_multiline_text_aligned(canvas, 64, 10, AlignCenter, AlignTop, "Countdown");
-
-        // Calculate from the time value minutes and seconds
-        // Technically we let you do more than 60 seconds in minute and seconds but it
-        // just makes more sense that way. Like a microwave (mmmmmmmvvvvvmmmmmmm)
-        uint8_t minutes = model->remaining_seconds / 60;
-        uint8_t seconds = model->remaining_seconds % 60;
+        if(model->wall_clock) {
+            snprintf(
+                text, sizeof(text), "Fire at %02d:%02d", model->fire_hour, model->fire_minute);
+            elements_multiline_text_aligned(canvas, 64, 10, AlignCenter, AlignTop, text);
+        } else {
+            elements_multiline_text_aligned(
+                canvas, 64, 10, AlignCenter, AlignTop, model->repeat ? "Interval" : "Countdown");
+        }
 
-        canvas_set_font(canvas, FontBigNumbers);
-        char timer_str[10];
-        snprintf(timer_str, sizeof(timer_str), "%02d:%02d", minutes, seconds);
-        elements_multiline_text_aligned(canvas, 64, 35, AlignCenter, AlignCenter, timer_str);
+        countdown_draw_remaining(canvas, model->remaining_ms, text, sizeof(text));
 
         canvas_set_font(canvas, FontSecondary);
         elements_multiline_text_aligned(
             canvas, 64, 55, AlignCenter, AlignBottom, "Press Back to cancel");
+
+        if(model->repeat && model->fire_count > 0) {
+            if(model->dual_output) {
+                // Shorter labels to make room for the gap between the two outputs
+                snprintf(
+                    text,
+                    sizeof(text),
+                    "#%lu  m%lu  +%ldms  %uus",
+                    model->fire_count,
+                    model->missed_count,
+                    model->last_jitter_ms,
+                    model->dead_time_us);
+            } else {
+                snprintf(
+                    text,
+                    sizeof(text),
+                    "#%lu  missed %lu  +%ldms",
+                    model->fire_count,
+                    model->missed_count,
+                    model->last_jitter_ms);
+            }
+            elements_multiline_text_aligned(canvas, 64, 64, AlignCenter, AlignBottom, text);
+        }
     } else if(model->state == CountdownState_Complete) {
         elements_multiline_text_aligned(canvas, 64, 10, AlignCenter, AlignTop, "Complete!");
 
         if(model->has_ir_signal && model->ir_sent) {
             elements_multiline_text_aligned(
                 canvas, 64, 30, AlignCenter, AlignTop, "IR Signal Sent");
+            if(model->dual_output) {
+                snprintf(text, sizeof(text), "Both outputs, %uus apart", model->dead_time_us);
+                canvas_set_font(canvas, FontSecondary);
+                elements_multiline_text_aligned(canvas, 64, 62, AlignCenter, AlignBottom, text);
+            }
         }
 
         canvas_set_font(canvas, FontSecondary);
         elements_multiline_text_aligned(
             canvas, 64, 50, AlignCenter, AlignBottom, "Press any key to return");
     }
+
+    pt_profile_end(PtProfileCountdownDraw, profile_start);
+    pt_profile_draw_hud(canvas, PtProfileCountdownDraw);
+    pt_stack_sample(PtStackDraw);
 }
 
-static void countdown_timer_callback(void* context) {
+// Jitter is how far from its deadline the IR actually went out. The fire timer is
+// armed early on purpose, so when it arrived says nothing about that.
+static void countdown_record_jitter(
+    CountdownUtils* countdown,
+    uint32_t deadline_tick,
+    const IrMacroFireReport* report) {
+    uint32_t fire_tick = report->sent ? report->first_tick : furi_get_tick();
+    int32_t jitter_ms = (int32_t)(fire_tick - deadline_tick) * 1000 /
+                        (int32_t)furi_kernel_get_tick_frequency();
+
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
+        {
+            if(model->state == CountdownState_Running) {
+                model->last_jitter_ms = jitter_ms;
+                if(jitter_ms > model->max_jitter_ms) model->max_jitter_ms = jitter_ms;
+            }
+        },
+        true);
+}
+
+static int32_t countdown_fire_thread(void* context) {
+    CountdownUtils* countdown = context;
+    CountdownFire fire;
+
+    while(furi_message_queue_get(countdown->fire_queue, &fire, FuriWaitForever) ==
+          FuriStatusOk) {
+        if(fire.stop) break;
+
+        // Clear a cancel meant for an earlier fire before checking this one is still wanted,
+        // a cancel landing in between then either drops it here or ends its macro
+        furi_semaphore_acquire(countdown->fire_cancel, 0);
+        if(fire.generation != countdown->fire_generation) continue;
+
+        IrMacroFireReport report = {0};
+        if(fire.send_ir) countdown_fire(countdown, fire.deadline_tick, &report);
+        countdown_journal_fire(countdown, fire.deadline_tick, fire.cycle, fire.missed, &report);
+        if(!report.cancelled) countdown_feedback(countdown, PtFeedbackFired);
+        if(fire.record_jitter) countdown_record_jitter(countdown, fire.deadline_tick, &report);
+        pt_stack_sample(PtStackFire);
+    }
+    return 0;
+}
+
+// Never blocks the caller, a fire still sending when the next one is due costs that one
+static void countdown_post_fire(CountdownUtils* countdown, CountdownFire* fire) {
+    fire->generation = countdown->fire_generation;
+    if(furi_message_queue_put(countdown->fire_queue, fire, 0) != FuriStatusOk) {
+        FURI_LOG_W(TAG, "Fire thread busy, cycle %lu not sent", fire->cycle);
+    }
+}
+
+// Ends the macro being sent before its next step and drops the fires still queued
+static void countdown_cancel_fire(CountdownUtils* countdown) {
+    countdown->fire_generation++;
+    furi_semaphore_release(countdown->fire_cancel);
+}
+
+static void countdown_fire_timer_callback(void* context) {
     furi_assert(context);
     CountdownUtils* countdown = context;
 
+    uint32_t now = furi_get_tick();
+    timer_latency_add(
+        &countdown->latency, countdown_ticks_past(now, countdown->fire_expected_tick));
+    countdown->fire_armed = false;
+
+    uint32_t fire_deadline = countdown->deadline_tick;
+    // Arriving early is expected, the macro waits for the deadline before sending
+    uint32_t late_ticks = countdown_ticks_past(now, fire_deadline);
+    uint32_t missed = 0;
+    uint32_t fired_cycle = countdown->cycle;
+
+    if(countdown->repeat) {
+        // Move to the first deadline still in the future, counting any we slept through
+        uint32_t elapsed_periods =
+            (fire_deadline + late_ticks - countdown->start_tick) / countdown->period_ticks;
+        missed = elapsed_periods - countdown->cycle;
+        fired_cycle = elapsed_periods;
+        countdown->cycle = elapsed_periods + 1;
+        countdown->deadline_tick =
+            countdown->start_tick + countdown->cycle * countdown->period_ticks;
+    }
+
+    bool fired = false;
     bool completed = false;
     bool send_ir = false;
 
-    with_view_model(
-        countdown->view,
-        CountdownModel * model,
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
         {
-            if(model->remaining_seconds > 0) {
-                model->remaining_seconds--;
-                if(model->remaining_seconds == 0) {
+            if(model->state == CountdownState_Running) {
+                fired = true;
+                send_ir = model->has_ir_signal;
+                model->ir_sent = send_ir;
+                if(countdown->repeat) {
+                    model->remaining_ms = countdown_remaining_ms(countdown, now);
+                    model->fire_count++;
+                    model->missed_count += missed;
+                } else {
+                    model->remaining_ms = 0;
                     model->state = CountdownState_Complete;
                     completed = true;
-                    send_ir = model->has_ir_signal;
-                    model->ir_sent = send_ir;
                 }
             }
         },
         true);
 
-    if(completed) {
-        if(send_ir) transmit_ir_signal(countdown->app);
+    if(fired) {
+        CountdownFire fire = {
+            .deadline_tick = fire_deadline,
+            .cycle = fired_cycle,
+            .missed = missed,
+            .send_ir = send_ir,
+            .record_jitter = !completed,
+        };
+        countdown_post_fire(countdown, &fire);
+    }
 
-        furi_hal_vibro_on(true);
-        furi_delay_ms(100);
-        furi_hal_vibro_on(false);
+    if(completed) {
+        countdown_stop_ticking(countdown);
+    } else if(fired) {
+        countdown_schedule_fire(countdown, furi_get_tick());
+    }
+    pt_stack_sample(PtStackTimer);
+}
 
-        furi_timer_stop(countdown->timer);
+// The tick deadline is only derived from the RTC once when the countdown starts, so
+// every so often check that the two still agree over hour long waits
+static void countdown_check_rtc(CountdownUtils* countdown, uint32_t now) {
+    if(countdown->fire_armed) return;
+    if(now - countdown->rtc_check_tick < furi_ms_to_ticks(COUNTDOWN_RTC_CHECK_S * 1000)) return;
+    countdown->rtc_check_tick = now;
+
+    uint32_t rtc_now = furi_hal_rtc_get_timestamp();
+    uint32_t rtc_remaining_s = countdown->fire_at > rtc_now ? countdown->fire_at - rtc_now : 0;
+    uint32_t rtc_deadline = now + furi_ms_to_ticks(rtc_remaining_s * 1000);
+    int32_t drift = (int32_t)(rtc_deadline - countdown->deadline_tick);
+
+    if((uint32_t)(drift < 0 ? -drift : drift) >= furi_ms_to_ticks(COUNTDOWN_RTC_DRIFT_MS)) {
+        FURI_LOG_I(TAG, "Deadline moved %ld ticks to follow the RTC", drift);
+        countdown->deadline_tick = rtc_deadline;
     }
 }
 
-static bool countdown_input_callback(InputEvent* event, void* context) {
+static void countdown_timer_callback(void* context) {
     furi_assert(context);
     CountdownUtils* countdown = context;
-    bool consumed = false;
 
-    with_view_model(
-        countdown->view,
-        CountdownModel * model,
+    // Each wake is scheduled for a known tick, anything past that is timer latency
+    uint32_t now = furi_get_tick();
+    uint32_t late_ticks = countdown_ticks_past(now, countdown->tick_expected_tick);
+    timer_latency_add(&countdown->latency, late_ticks);
+
+    pt_profile_timer_jitter(late_ticks * 1000 / furi_kernel_get_tick_frequency());
+    pt_trace(PtTraceTick, countdown_remaining_ms(countdown, now), late_ticks);
+
+    if(countdown->fire_at) {
+        countdown_check_rtc(countdown, now);
+    }
+
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
         {
-            if(event->type == InputTypeShort) {
-                if(model->state == CountdownState_Running) {
-                    // Cancel countdown on Back press
-                    if(event->key == InputKeyBack) {
-                        model->state = CountdownState_Complete;
-                        furi_timer_stop(countdown->timer);
-                        consumed = true;
-                    }
-                } else if(model->state == CountdownState_Complete) {
-                    // Any key to return
-                    if(countdown->app && countdown->app->scene_manager) {
-                        scene_manager_previous_scene(countdown->app->scene_manager);
-                    }
-                    consumed = true;
-                }
+            if(model->state == CountdownState_Running) {
+                model->remaining_ms = countdown_remaining_ms(countdown, now);
             }
         },
         true);
 
+    countdown_schedule_tick(countdown, now);
+    countdown_schedule_fire(countdown, now);
+    pt_stack_sample(PtStackTimer);
+}
+
+static bool countdown_process_input(InputEvent* event, void* context) {
+    furi_assert(context);
+    CountdownUtils* countdown = context;
+    bool consumed = false;
+
+    if(event->type != InputTypeShort) return consumed;
+
+    CountdownSnapshot snapshot;
+    countdown_model_read(countdown->model, &snapshot);
+
+    if(snapshot.state == CountdownState_Running) {
+        // Cancel countdown on Back press
+        if(event->key == InputKeyBack) {
+            countdown_stop_ticking(countdown);
+            furi_timer_stop(countdown->fire_timer);
+            countdown_cancel_fire(countdown);
+            with_countdown_model(
+                countdown,
+                CountdownSnapshot * model,
+                { model->state = CountdownState_Complete; },
+                true);
+            countdown_feedback(countdown, PtFeedbackCancelled);
+            consumed = true;
+        }
+    } else if(snapshot.state == CountdownState_Complete) {
+        // Any key to return
+        if(countdown->app && countdown->app->scene_manager) {
+            scene_manager_previous_scene(countdown->app->scene_manager);
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+static bool countdown_input_callback(InputEvent* event, void* context) {
+    uint32_t replay_start = input_replay_event_begin();
+    bool consumed = pt_profile_input(event) || countdown_process_input(event, context);
+    pt_stack_sample(PtStackApp);
+    input_replay_event_end(replay_start);
     return consumed;
 }
 
@@ -168,23 +647,58 @@ CountdownUtils* countdown_utils_alloc() {
     CountdownUtils* countdown = malloc(sizeof(CountdownUtils));
     countdown->view = view_alloc();
     view_set_context(countdown->view, countdown);
-    view_allocate_model(countdown->view, ViewModelTypeLocking, sizeof(CountdownModel));
+    view_allocate_model(countdown->view, ViewModelTypeLockFree, sizeof(CountdownModel));
     view_set_draw_callback(countdown->view, countdown_draw_callback);
     view_set_input_callback(countdown->view, countdown_input_callback);
 
     countdown->timer =
-        furi_timer_alloc(countdown_timer_callback, FuriTimerTypePeriodic, countdown);
+        furi_timer_alloc(countdown_timer_callback, FuriTimerTypeOnce, countdown);
+    countdown->fire_timer =
+        furi_timer_alloc(countdown_fire_timer_callback, FuriTimerTypeOnce, countdown);
+    countdown->fire_queue =
+        furi_message_queue_alloc(COUNTDOWN_FIRE_QUEUE_SIZE, sizeof(CountdownFire));
+    countdown->fire_cancel = furi_semaphore_alloc(1, 0);
+    countdown->fire_generation = 0;
+    countdown->fire_thread =
+        furi_thread_alloc_ex("PtFire", 1024, countdown_fire_thread, countdown);
+    // The macro waits out the last ticks to the deadline itself, nothing may delay it
+    furi_thread_set_priority(countdown->fire_thread, FuriThreadPriorityHighest);
+    furi_thread_start(countdown->fire_thread);
+    timer_latency_reset(&countdown->latency);
     countdown->app = NULL;
-
-    with_view_model(
-        countdown->view,
-        CountdownModel * model,
+    countdown->fire_at = 0;
+    countdown->ticking = false;
+    countdown->tick_expected_tick = 0;
+    countdown->rtc_check_tick = 0;
+    countdown_arm(countdown, 0, 0, false);
+
+    // Lock free models hand back the same pointer every time, so keep it around
+    countdown->model = view_get_model(countdown->view);
+    view_commit_model(countdown->view, false);
+    countdown->model->sequence = 0;
+    countdown->write_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    countdown->lock_stats = (LockStats){.name = "countdown"};
+    countdown->lock_start = 0;
+
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
         {
             model->total_seconds = 0;
-            model->remaining_seconds = 0;
+            model->remaining_ms = 0;
+            model->fire_hour = 0;
+            model->fire_minute = 0;
+            model->wall_clock = false;
             model->state = CountdownState_Running;
             model->has_ir_signal = false;
             model->ir_sent = false;
+            model->repeat = false;
+            model->fire_count = 0;
+            model->missed_count = 0;
+            model->last_jitter_ms = 0;
+            model->max_jitter_ms = 0;
+            model->dead_time_us = 0;
+            model->dual_output = false;
         },
         true);
 
@@ -195,11 +709,27 @@ void countdown_utils_free(CountdownUtils* countdown) {
     furi_assert(countdown);
 
     if(countdown->timer) {
-        furi_timer_stop(countdown->timer);
+        countdown_stop_ticking(countdown);
         furi_timer_free(countdown->timer);
         countdown->timer = NULL;
     }
+    if(countdown->fire_timer) {
+        furi_timer_stop(countdown->fire_timer);
+        furi_timer_free(countdown->fire_timer);
+        countdown->fire_timer = NULL;
+    }
+    // A macro that is still sending ends before its next step, so the join is short
+    countdown_cancel_fire(countdown);
+    CountdownFire stop = {.stop = true};
+    furi_message_queue_put(countdown->fire_queue, &stop, FuriWaitForever);
+    furi_thread_join(countdown->fire_thread);
+    furi_thread_free(countdown->fire_thread);
+    furi_message_queue_free(countdown->fire_queue);
+    furi_semaphore_free(countdown->fire_cancel);
+    timer_latency_log(&countdown->latency, "countdown");
+    lock_stats_log(&countdown->lock_stats);
     view_free(countdown->view);
+    furi_mutex_free(countdown->write_mutex);
     free(countdown);
 }
 
@@ -208,56 +738,84 @@ View* countdown_get_view(CountdownUtils* countdown) {
     return countdown->view;
 }
 
+const TimerLatency* countdown_get_timer_latency(CountdownUtils* countdown) {
+    furi_assert(countdown);
+    return &countdown->latency;
+}
+
 void countdown_set_args(CountdownUtils* countdown, CountdownArgs* args) {
     furi_assert(countdown);
     furi_assert(args);
 
     countdown->app = args->app;
 
-    with_view_model(
-        countdown->view,
-        CountdownModel * model,
+    // A wall clock target is turned into a tick deadline once here, countdown_check_rtc
+    // keeps the two in line afterwards
+    uint32_t duration_s = args->duration_s;
+    bool repeat = args->repeat;
+    // Started by a remote press, count from when it was received rather than from now
+    uint32_t start_tick = args->start_tick ? args->start_tick : furi_get_tick();
+    countdown->fire_at = args->fire_at;
+    if(countdown->fire_at) {
+        uint32_t rtc_now = furi_hal_rtc_get_timestamp();
+        duration_s = countdown->fire_at > rtc_now ? countdown->fire_at - rtc_now : 0;
+        repeat = false;
+    }
+
+    bool start_timer = false;
+    bool fire_now = false;
+
+    with_countdown_model(
+        countdown,
+        CountdownSnapshot * model,
         {
-            // Convert from MMSS format to total seconds
-            uint8_t minutes = args->timer_val / 100;
-            uint8_t seconds = args->timer_val % 100;
-            model->total_seconds = minutes * 60 + seconds;
-            model->remaining_seconds = model->total_seconds;
+            model->total_seconds = duration_s;
+            model->wall_clock = countdown->fire_at != 0;
+            if(model->wall_clock) {
+                DateTime fire_time;
+                datetime_timestamp_to_datetime(countdown->fire_at, &fire_time);
+                model->fire_hour = fire_time.hour;
+                model->fire_minute = fire_time.minute;
+            }
+            model->remaining_ms = model->total_seconds * 1000;
             model->has_ir_signal = args->has_ir_signal;
             model->state = CountdownState_Running;
             model->ir_sent = false;
+            model->fire_count = 0;
+            model->missed_count = 0;
+            model->last_jitter_ms = 0;
+            model->max_jitter_ms = 0;
+            model->dead_time_us = 0;
+            model->dual_output = false;
+            countdown_arm(countdown, start_tick, model->total_seconds, repeat);
+            model->repeat = countdown->repeat;
 
             if(model->total_seconds > 0) {
-                furi_timer_start(countdown->timer, 1000);
+                start_timer = true;
             } else {
                 // Edge case where if timer is 0, complete immediately
                 model->state = CountdownState_Complete;
-                if(model->has_ir_signal) {
-                    transmit_ir_signal(countdown->app);
-                    model->ir_sent = true;
-                }
+                fire_now = model->has_ir_signal;
+                model->ir_sent = fire_now;
             }
         },
         true);
-}
-
-void countdown_start(CountdownUtils* countdown) {
-    furi_assert(countdown);
 
-    with_view_model(
-        countdown->view,
-        CountdownModel * model,
-        {
-            model->state = CountdownState_Running;
-            model->remaining_seconds = model->total_seconds;
-            if(model->total_seconds > 0) {
-                furi_timer_start(countdown->timer, 1000);
-            }
-        },
-        true);
+    if(start_timer) {
+        countdown_start_ticking(countdown);
+    } else {
+        CountdownFire fire = {
+            .deadline_tick = countdown->deadline_tick,
+            .cycle = 1,
+            .send_ir = fire_now,
+        };
+        countdown_post_fire(countdown, &fire);
+    }
 }
 
 void stop_countdown(CountdownUtils* countdown) {
     furi_assert(countdown);
-    furi_timer_stop(countdown->timer);
+    countdown_stop_ticking(countdown);
+    furi_timer_stop(countdown->fire_timer);
+    countdown_cancel_fire(countdown);
 }
@@ -2,19 +2,23 @@
 
 #include <gui/view.h>
 #include <infrared.h>
+#include "../helpers/timer_latency.h"
 
 typedef struct PauseTimerApp PauseTimerApp;
 typedef struct CountdownUtils CountdownUtils;
 
 typedef struct {
-    uint16_t timer_val;
+    uint32_t duration_s;
+    uint32_t fire_at; // RTC timestamp to fire at instead of duration_s, 0 when unused
     bool has_ir_signal;
+    bool repeat; // Keep firing every duration_s instead of stopping after the first
+    uint32_t start_tick; // Tick duration_s is counted from, 0 to count from now
     PauseTimerApp* app;
 } CountdownArgs;
 
 CountdownUtils* countdown_utils_alloc();
 void countdown_utils_free(CountdownUtils* countdown);
 View* countdown_get_view(CountdownUtils* countdown);
+const TimerLatency* countdown_get_timer_latency(CountdownUtils* countdown);
 void countdown_set_args(CountdownUtils* countdown, CountdownArgs* args);
-void countdown_start(CountdownUtils* countdown);
 void stop_countdown(CountdownUtils* countdown);
\ No newline at end of file
@@ -2,6 +2,16 @@
 #include <gui/elements.h>
 #include <furi.h>
 #include <furi_hal.h>
+#include "../helpers/lock_stats.h"
+#include "../helpers/input_replay.h"
+#include "../helpers/pt_trace.h"
+#include "../helpers/pt_profile.h"
+#include "../helpers/stack_stats.h"
+#include "../helpers/pt_memory.h"
+#include "../helpers/ir_fingerprint.h"
+#include "../helpers/ir_carrier.h"
+
+#define TAG "PT"
 
 struct IrLearnArgs {
     View* view;
@@ -9,44 +19,219 @@ struct IrLearnArgs {
     IrLearnSignalLearnedCallback signal_learned_callback;
     IrLearnBackCallback back_callback;
     void* context;
+    IrLearnMatchCallback match_callback;
+    void* match_context;
+    IrLearnImportCallback import_callback;
+    void* import_context;
+    PtFeedback* feedback;
+    IrLearnTriggerCallback trigger_callback;
+    void* trigger_context;
     IrLearnResult result;
-    bool should_stop_worker;
+    uint16_t max_timings; // Longer raw captures are refused before anything is allocated
     volatile bool alive;
+    LockStats lock_stats;
+
+    // The receiver is started and stopped from the GUI and the timer thread
+    FuriMutex* worker_mutex;
+    bool worker_running;
+    FuriTimer* idle_timer;
+    uint32_t idle_timeout_ms;
+    uint32_t rx_start_tick;
+    uint32_t rx_active_ticks; // Receiver on time since ir_learn_start_receiving
+
+    // Armed listening, set up before the receiver starts and then only used by the worker
+    volatile bool listening;
+    bool triggered;
+    uint32_t trigger_fingerprint;
 };
 
+typedef enum {
+    IrLearnStateReceiving,
+    IrLearnStateCaptured,
+    IrLearnStateIdle, // Receiver powered down after idle_timeout_ms without a capture
+    IrLearnStatePickTrigger, // Listening, the next signal becomes the trigger
+    IrLearnStateListening, // Listening for the trigger
+} IrLearnState;
+
+typedef enum {
+    IrLearnRejectNone,
+    IrLearnRejectTooLong, // More timings than a slot can hold
+    IrLearnRejectLowMemory, // The heap can't take a copy of the capture
+} IrLearnReject;
+
+// The capture is kept as-is and its description is only formatted while drawing
 typedef struct {
-    bool receiving;
-    bool signal_received;
-    bool is_decoded;
-    char message[64];
+    IrLearnResult capture;
+    uint8_t state; // IrLearnState
+    uint8_t reject; // IrLearnReject, why the last capture wasn't kept
+    bool appending; // The capture becomes a later step of a macro and has a wait before it
+    uint8_t step_delay; // That wait in IR_LEARN_DELAY_STEP_MS units
 } IrLearnModel;
 
+PT_SIZE_BUDGET(IrLearnModel, 32);
+
+static void ir_learn_format_capture(const IrLearnResult* capture, char* buffer, size_t size) {
+    const IrSignalStorage* signal = &capture->signal;
+    int length = 0;
+
+    if(signal->kind == IrSignalKindDecoded) {
+        const char* protocol_name = infrared_get_protocol_name(signal->decoded.protocol);
+        if(protocol_name) {
+            length = snprintf(
+                buffer,
+                size,
+                "%s: 0x%lX 0x%lX",
+                protocol_name,
+                signal->decoded.address,
+                signal->decoded.command);
+        } else {
+            length = snprintf(buffer, size, "Protocol: %d", signal->decoded.protocol);
+        }
+    } else if(signal->kind == IrSignalKindRaw) {
+        length = snprintf(
+            buffer,
+            size,
+            "Raw: %d @ %d.%d kHz",
+            signal->raw.timings_size,
+            signal->raw.frequency / 1000,
+            (signal->raw.frequency % 1000) / 100);
+    } else {
+        snprintf(buffer, size, "No signal received");
+        return;
+    }
+
+    // Tell the user when they just captured a button they already have
+    if(capture->is_known && length > 0 && (size_t)length < size) {
+        snprintf(
+            buffer + length,
+            size - length,
+            "\nSame as slot %d step %d",
+            capture->known_slot + 1,
+            capture->known_step + 1);
+    }
+}
+
 static void ir_learn_draw_callback(Canvas* canvas, void* context) {
     furi_assert(context);
     IrLearnModel* model = context;
+    input_replay_draw();
 
+    bool listening = model->state == IrLearnStatePickTrigger ||
+                     model->state == IrLearnStateListening;
     canvas_clear(canvas);
     canvas_set_font(canvas, FontPrimary);
-    elements_multiline_text_aligned(canvas, 64, 10, AlignCenter, AlignTop, "IR Learning");
+    elements_multiline_text_aligned(
+        canvas, 64, 10, AlignCenter, AlignTop, listening ? "Armed" : "IR Learning");
 
     canvas_set_font(canvas, FontSecondary);
 
-    if(model->receiving) {
+    if(model->state == IrLearnStatePickTrigger) {
         elements_multiline_text_aligned(
-            canvas, 64, 25, AlignCenter, AlignTop, "Waiting for IR signal...");
+            canvas, 64, 25, AlignCenter, AlignTop, "Press the button that");
         elements_multiline_text_aligned(
-            canvas, 64, 45, AlignCenter, AlignTop, "Point remote at Flipper");
-    } else if(model->signal_received) {
-        elements_multiline_text_aligned(canvas, 64, 25, AlignCenter, AlignTop, "Signal Learned!");
-        elements_multiline_text_aligned(canvas, 64, 37, AlignCenter, AlignTop, model->message);
+            canvas, 64, 36, AlignCenter, AlignTop, "should start the timer");
+    } else if(model->state == IrLearnStateListening) {
         elements_multiline_text_aligned(
-            canvas, 64, 55, AlignCenter, AlignBottom, "Press OK to continue");
+            canvas, 64, 25, AlignCenter, AlignTop, "Waiting for the trigger");
+        elements_multiline_text_aligned(
+            canvas, 64, 36, AlignCenter, AlignTop, "button on your remote");
+    } else if(model->state == IrLearnStateReceiving) {
+        elements_multiline_text_aligned(
+            canvas, 64, 23, AlignCenter, AlignTop, "Waiting for IR signal...");
+        const char* hint = "Point remote at Flipper";
+        if(model->reject == IrLearnRejectTooLong) {
+            // An appended step only gets what the earlier steps left of the slot
+            hint = model->appending ? "No room left in slot" : "Too long, tap it briefly";
+        } else if(model->reject == IrLearnRejectLowMemory) {
+            hint = "Low memory, not kept";
+        }
+        elements_multiline_text_aligned(canvas, 64, 34, AlignCenter, AlignTop, hint);
+        elements_multiline_text_aligned(
+            canvas, 64, 44, AlignCenter, AlignTop, "or Right to import a file");
+    } else if(model->state == IrLearnStateIdle) {
+        elements_multiline_text_aligned(
+            canvas, 64, 25, AlignCenter, AlignTop, "Receiver off to save power");
+        elements_multiline_text_aligned(
+            canvas, 64, 45, AlignCenter, AlignTop, "Tap OK to resume");
     } else {
-        furi_crash("Reached impossible state");
+        char message[48];
+        if(ir_signal_is_set(&model->capture.signal)) {
+            if(model->appending) {
+                uint32_t delay_ms = model->step_delay * IR_LEARN_DELAY_STEP_MS;
+                snprintf(
+                    message,
+                    sizeof(message),
+                    "Wait %lu.%lu s (Up/Down)",
+                    delay_ms / 1000,
+                    (delay_ms % 1000) / 100);
+            } else {
+                snprintf(message, sizeof(message), "Signal Learned!");
+            }
+            elements_multiline_text_aligned(canvas, 64, 25, AlignCenter, AlignTop, message);
+        }
+        ir_learn_format_capture(&model->capture, message, sizeof(message));
+        elements_multiline_text_aligned(canvas, 64, 37, AlignCenter, AlignTop, message);
+        elements_multiline_text_aligned(
+            canvas, 64, 55, AlignCenter, AlignBottom, "Press OK to continue");
     }
 
     elements_multiline_text_aligned(
         canvas, 64, 63, AlignCenter, AlignBottom, "Press Back to cancel");
+
+    pt_profile_draw_hud(canvas, PtProfileIrRx);
+    pt_stack_sample(PtStackDraw);
+}
+
+// Listening only needs the fingerprint, so signals that don't match are never copied,
+// stored or drawn
+static void ir_learn_listen_rx(IrLearnArgs* ir_learn, InfraredWorkerSignal* received_signal) {
+    if(ir_learn->triggered) return;
+
+    uint32_t fingerprint = IR_FINGERPRINT_NONE;
+    if(infrared_worker_signal_is_decoded(received_signal)) {
+        const InfraredMessage* message = infrared_worker_get_decoded_signal(received_signal);
+        // Holding a button sends repeat frames, only the press itself counts
+        if(message && !message->repeat) fingerprint = ir_fingerprint_decoded(message);
+    } else {
+        const uint32_t* timings;
+        size_t timings_size;
+        infrared_worker_get_raw_signal(received_signal, &timings, &timings_size);
+        if(timings && timings_size) fingerprint = ir_fingerprint_raw(timings, timings_size);
+    }
+    if(fingerprint == IR_FINGERPRINT_NONE) return;
+
+    bool picked = ir_learn->trigger_fingerprint == IR_FINGERPRINT_NONE;
+    if(picked) {
+        ir_learn->trigger_fingerprint = fingerprint;
+        pt_feedback_play(ir_learn->feedback, PtFeedbackLearned);
+        with_view_model_timed(
+            &ir_learn->lock_stats,
+            ir_learn->view,
+            IrLearnModel * model,
+            { model->state = IrLearnStateListening; },
+            true);
+    } else if(fingerprint == ir_learn->trigger_fingerprint) {
+        // Only once, the receiver keeps running until the scene moves on
+        ir_learn->triggered = true;
+    } else {
+        return;
+    }
+
+    if(ir_learn->trigger_callback) {
+        ir_learn->trigger_callback(ir_learn->trigger_context, fingerprint, picked);
+    }
+}
+
+// Keeps receiving and says why on screen, so the user can simply try again
+static void ir_learn_reject(IrLearnArgs* ir_learn, IrLearnReject reject, size_t timings_size) {
+    FURI_LOG_W(TAG, "Capture of %d timings not kept, reason %d", (int)timings_size, reject);
+    pt_feedback_play(ir_learn->feedback, PtFeedbackNotStored);
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        { model->reject = reject; },
+        true);
 }
 
 static void ir_learn_worker_rx_callback(void* context, InfraredWorkerSignal* received_signal) {
@@ -56,170 +241,379 @@ static void ir_learn_worker_rx_callback(void* context, InfraredWorkerSignal* rec
     if(!ir_learn->alive) {
         return;
     }
+    if(ir_learn->listening) {
+        ir_learn_listen_rx(ir_learn, received_signal);
+        pt_stack_sample(PtStackIrRx);
+        return;
+    }
+    uint32_t profile_start = pt_profile_begin();
 
-    bool signal_received = false;
-    bool is_decoded = false;
-    InfraredMessage decoded_message = {0};
+    IrLearnResult capture = {0};
     uint32_t* raw_timings = NULL;
-    size_t raw_timings_size = 0;
-    char display_message[64] = {0};
 
     if(infrared_worker_signal_is_decoded(received_signal)) {
         const InfraredMessage* message = infrared_worker_get_decoded_signal(received_signal);
         if(message) {
-            signal_received = true;
-            is_decoded = true;
-            decoded_message = *message;
-
-            const char* protocol_name = infrared_get_protocol_name(message->protocol);
-            if(protocol_name) {
-                snprintf(
-                    display_message,
-                    sizeof(display_message),
-                    "%s: 0x%lX 0x%lX",
-                    protocol_name,
-                    message->address,
-                    message->command);
-            } else {
-                snprintf(
-                    display_message, sizeof(display_message), "Protocol: %d", message->protocol);
-            }
+            ir_signal_set_decoded(&capture.signal, message);
+            pt_trace(PtTraceRxProtocol, message->protocol, message->repeat);
+            pt_trace(PtTraceRxDecoded, message->address, message->command);
         }
     } else {
         // Handle raw signal
         const uint32_t* timings;
         size_t timings_size;
         infrared_worker_get_raw_signal(received_signal, &timings, &timings_size);
+        pt_trace(PtTraceRxRaw, timings_size, 0);
+
+        // The worker caps captures far below what the 16 bit size can hold
+        if(timings && timings_size > 0 && timings_size <= UINT16_MAX) {
+            // Refuse up front what can't be stored, rather than copy it and fail later
+            IrLearnReject reject = IrLearnRejectNone;
+            if(timings_size > ir_learn->max_timings) {
+                reject = IrLearnRejectTooLong;
+            } else if(!pt_memory_can_alloc(timings_size * sizeof(uint32_t))) {
+                reject = IrLearnRejectLowMemory;
+            }
+            if(reject != IrLearnRejectNone) {
+                ir_learn_reject(ir_learn, reject, timings_size);
+                pt_profile_end(PtProfileIrRx, profile_start);
+                pt_stack_sample(PtStackIrRx);
+                return;
+            }
 
-        if(timings && timings_size > 0) {
             // copy timings
             raw_timings = malloc(timings_size * sizeof(uint32_t));
             if(raw_timings) {
                 memcpy(raw_timings, timings, timings_size * sizeof(uint32_t));
-                raw_timings_size = timings_size;
-                signal_received = true;
-                is_decoded = false;
-
-                snprintf(
-                    display_message, sizeof(display_message), "Raw: %d timings", (int)timings_size);
+                IrCarrier carrier = ir_carrier_estimate(timings, timings_size);
+                ir_signal_set_raw(
+                    &capture.signal,
+                    raw_timings,
+                    timings_size,
+                    carrier.frequency,
+                    carrier.duty_cycle);
             }
         }
     }
 
-    if(!signal_received) {
-        snprintf(display_message, sizeof(display_message), "No signal received");
+    bool signal_received = ir_signal_is_set(&capture.signal);
+    if(signal_received) {
+        capture.signal.fingerprint = ir_fingerprint_signal(&capture.signal);
+        if(ir_learn->match_callback) {
+            capture.is_known = ir_learn->match_callback(
+                ir_learn->match_context,
+                capture.signal.fingerprint,
+                &capture.known_slot,
+                &capture.known_step);
+        }
     }
 
-    with_view_model(
+    with_view_model_timed(
+        &ir_learn->lock_stats,
         ir_learn->view,
         IrLearnModel * model,
         {
-            model->receiving = false;
-            model->signal_received = signal_received;
-            model->is_decoded = is_decoded;
-            strncpy(model->message, display_message, sizeof(model->message) - 1);
-            model->message[sizeof(model->message) - 1] = '\0';
+            model->state = IrLearnStateCaptured;
+            model->capture = capture;
+            model->reject = IrLearnRejectNone;
         },
         true);
 
     // Store the raw timings in the result if we have them
     if(signal_received) {
         // Clear previous result
-        if(ir_learn->result.raw_timings) {
-            free(ir_learn->result.raw_timings);
-            ir_learn->result.raw_timings = NULL;
-            ir_learn->result.raw_timings_size = 0;
+        if(ir_learn->result.signal.kind == IrSignalKindRaw) {
+            free(ir_learn->result.signal.raw.timings);
         }
+        ir_learn->result = capture;
+    }
 
-        ir_learn->result.has_signal = true;
-        ir_learn->result.is_decoded = is_decoded;
+    // The worker can't be stopped from its own callback, let the timer thread do it
+    furi_timer_start(ir_learn->idle_timer, 1);
 
-        if(is_decoded) {
-            ir_learn->result.decoded_message = decoded_message;
-        } else {
-            ir_learn->result.raw_timings = raw_timings;
-            ir_learn->result.raw_timings_size = raw_timings_size;
-            ir_learn->result.frequency = 38000;
-            ir_learn->result.duty_cycle = 0.33f;
-        }
+    pt_profile_end(PtProfileIrRx, profile_start);
 
-        // Set a flag to indicate we should stop the worker
-        ir_learn->should_stop_worker = true;
-    } else {
-        if(raw_timings) {
-            free(raw_timings);
-        }
-        ir_learn->should_stop_worker = true;
+    // Buzz to show we grabbed a signal, without holding up the worker thread
+    pt_feedback_play(ir_learn->feedback, PtFeedbackLearned);
+    pt_stack_sample(PtStackIrRx);
+}
+
+static void ir_learn_arm_idle_timer(IrLearnArgs* ir_learn) {
+    if(ir_learn->idle_timeout_ms) {
+        furi_timer_start(ir_learn->idle_timer, furi_ms_to_ticks(ir_learn->idle_timeout_ms));
+    }
+}
+
+static void ir_learn_rx_start(IrLearnArgs* ir_learn) {
+    furi_mutex_acquire(ir_learn->worker_mutex, FuriWaitForever);
+    if(!ir_learn->worker_running) {
+        // Listening can go on for an hour, so it doesn't flash the LED for every signal
+        infrared_worker_rx_enable_blink_on_receiving(
+            ir_learn->infrared_worker, !ir_learn->listening);
+        infrared_worker_rx_enable_signal_decoding(ir_learn->infrared_worker, true);
+        infrared_worker_rx_set_received_signal_callback(
+            ir_learn->infrared_worker, ir_learn_worker_rx_callback, ir_learn);
+        infrared_worker_rx_start(ir_learn->infrared_worker);
+        ir_learn->worker_running = true;
+        ir_learn->rx_start_tick = furi_get_tick();
     }
+    furi_mutex_release(ir_learn->worker_mutex);
 
-    // Vibrate quick to show we grabbed a signal
-    furi_hal_vibro_on(true);
-    furi_delay_ms(100);
-    furi_hal_vibro_on(false);
+    // Armed listening has to stay on until the trigger comes
+    if(!ir_learn->listening) {
+        ir_learn_arm_idle_timer(ir_learn);
+    }
 }
 
-static bool ir_learn_input_callback(InputEvent* event, void* context) {
+// Returns whether the receiver was running
+static bool ir_learn_rx_stop(IrLearnArgs* ir_learn) {
+    furi_mutex_acquire(ir_learn->worker_mutex, FuriWaitForever);
+    bool was_running = ir_learn->worker_running;
+    if(was_running) {
+        infrared_worker_rx_stop(ir_learn->infrared_worker);
+        infrared_worker_rx_enable_blink_on_receiving(ir_learn->infrared_worker, false);
+        ir_learn->worker_running = false;
+        ir_learn->rx_active_ticks += furi_get_tick() - ir_learn->rx_start_tick;
+    }
+    furi_mutex_release(ir_learn->worker_mutex);
+    return was_running;
+}
+
+// Runs on the timer thread, either the idle timeout ran out or a capture asked for the
+// receiver to be stopped
+static void ir_learn_idle_timer_callback(void* context) {
+    IrLearnArgs* ir_learn = context;
+    if(!ir_learn_rx_stop(ir_learn)) return;
+
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        {
+            if(model->state == IrLearnStateReceiving) {
+                model->state = IrLearnStateIdle;
+            }
+        },
+        true);
+    pt_stack_sample(PtStackTimer);
+}
+
+static bool ir_learn_process_input(InputEvent* event, void* context) {
     furi_assert(context);
     IrLearnArgs* ir_learn = context;
     bool consumed = false;
 
-    // Check if we need to stop the worker (from callback)
-    if(ir_learn->should_stop_worker) {
-        infrared_worker_rx_stop(ir_learn->infrared_worker);
-        ir_learn->should_stop_worker = false;
+    // Holding Up or Down keeps changing the wait before the step
+    bool adjust = event->key == InputKeyUp || event->key == InputKeyDown;
+    if(event->type != InputTypeShort && !(adjust && event->type == InputTypeRepeat)) {
+        return consumed;
     }
 
-    with_view_model(
+    // Only snapshot the state while locked, the callbacks below switch scenes
+    IrLearnState state = IrLearnStateReceiving;
+    bool signal_received = false;
+    bool appending = false;
+
+    with_view_model_timed(
+        &ir_learn->lock_stats,
         ir_learn->view,
         IrLearnModel * model,
         {
-            if(event->type == InputTypeShort) {
-                if(event->key == InputKeyOk) {
-                    if(model->signal_received) {
-                        // Signal learned, return to main
-                        if(ir_learn->signal_learned_callback) {
-                            ir_learn->signal_learned_callback(ir_learn->context);
-                        }
-                        consumed = true;
-                    }
-                    // If no signal received yet, do nothing (still receiving)
-                } else if(event->key == InputKeyBack) {
-                    // Stop receiving if active
-                    if(model->receiving) {
-                        infrared_worker_rx_stop(ir_learn->infrared_worker);
+            state = model->state;
+            signal_received = ir_signal_is_set(&model->capture.signal);
+            appending = model->appending;
+        },
+        false);
+
+    if(adjust) {
+        if(state == IrLearnStateCaptured && signal_received && appending) {
+            with_view_model_timed(
+                &ir_learn->lock_stats,
+                ir_learn->view,
+                IrLearnModel * model,
+                {
+                    if(event->key == InputKeyUp && model->step_delay < UINT8_MAX) {
+                        model->step_delay++;
+                    } else if(event->key == InputKeyDown && model->step_delay > 0) {
+                        model->step_delay--;
                     }
+                },
+                true);
+            consumed = true;
+        }
+        return consumed;
+    }
 
-                    // Call the back button callback
-                    if(ir_learn->back_callback) {
-                        ir_learn->back_callback(ir_learn->context);
-                    }
-                    consumed = true;
-                }
+    if(state == IrLearnStateReceiving) {
+        // Someone is still at the screen, give them the full timeout again
+        ir_learn_arm_idle_timer(ir_learn);
+    }
+
+    if(event->key == InputKeyOk) {
+        if(state == IrLearnStateCaptured && signal_received) {
+            // Signal learned, return to main
+            if(ir_learn->signal_learned_callback) {
+                ir_learn->signal_learned_callback(ir_learn->context);
             }
-        },
-        true);
+            consumed = true;
+        } else if(state == IrLearnStateIdle) {
+            with_view_model_timed(
+                &ir_learn->lock_stats,
+                ir_learn->view,
+                IrLearnModel * model,
+                { model->state = IrLearnStateReceiving; },
+                true);
+            ir_learn_rx_start(ir_learn);
+            consumed = true;
+        }
+        // If no signal received yet, do nothing (still receiving)
+    } else if(
+        event->key == InputKeyRight &&
+        (state == IrLearnStateReceiving || state == IrLearnStateIdle)) {
+        // Take the signal from an Infrared app file instead, the scene switch stops the receiver
+        if(ir_learn->import_callback) {
+            ir_learn->import_callback(ir_learn->import_context);
+            consumed = true;
+        }
+    } else if(event->key == InputKeyBack) {
+        ir_learn_stop_receiving(ir_learn);
+
+        // Call the back button callback
+        if(ir_learn->back_callback) {
+            ir_learn->back_callback(ir_learn->context);
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
 
+static bool ir_learn_input_callback(InputEvent* event, void* context) {
+    uint32_t replay_start = input_replay_event_begin();
+    bool consumed = pt_profile_input(event) || ir_learn_process_input(event, context);
+    pt_stack_sample(PtStackApp);
+    input_replay_event_end(replay_start);
     return consumed;
 }
 
 void ir_learn_start_receiving(IrLearnArgs* ir_learn) {
     furi_assert(ir_learn);
 
-    with_view_model(
+    with_view_model_timed(
+        &ir_learn->lock_stats,
         ir_learn->view,
         IrLearnModel * model,
         {
-            model->receiving = true;
-            model->signal_received = false;
-            memset(model->message, 0, sizeof(model->message));
+            model->state = IrLearnStateReceiving;
+            memset(&model->capture, 0, sizeof(model->capture));
+            model->reject = IrLearnRejectNone;
         },
         true);
 
-    infrared_worker_rx_enable_blink_on_receiving(ir_learn->infrared_worker, true);
-    infrared_worker_rx_enable_signal_decoding(ir_learn->infrared_worker, true);
-    infrared_worker_rx_set_received_signal_callback(
-        ir_learn->infrared_worker, ir_learn_worker_rx_callback, ir_learn);
-    infrared_worker_rx_start(ir_learn->infrared_worker);
+    ir_learn->rx_active_ticks = 0;
+    ir_learn_rx_start(ir_learn);
+}
+
+void ir_learn_stop_receiving(IrLearnArgs* ir_learn) {
+    furi_assert(ir_learn);
+
+    furi_timer_stop(ir_learn->idle_timer);
+    ir_learn_rx_stop(ir_learn);
+    // The worker has been joined, no callback can see this change half way
+    ir_learn->listening = false;
+
+    // Report the session once, however many times the receiver was resumed in it
+    if(ir_learn->rx_active_ticks) {
+        FURI_LOG_I(
+            TAG,
+            "Receiver was on for %lu ms",
+            ir_learn->rx_active_ticks * 1000 / furi_kernel_get_tick_frequency());
+        ir_learn->rx_active_ticks = 0;
+    }
+}
+
+void ir_learn_start_listening(IrLearnArgs* ir_learn, uint32_t trigger_fingerprint) {
+    furi_assert(ir_learn);
+
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        {
+            model->state = trigger_fingerprint == IR_FINGERPRINT_NONE ?
+                               IrLearnStatePickTrigger :
+                               IrLearnStateListening;
+            memset(&model->capture, 0, sizeof(model->capture));
+            model->reject = IrLearnRejectNone;
+        },
+        true);
+
+    ir_learn->trigger_fingerprint = trigger_fingerprint;
+    ir_learn->triggered = false;
+    ir_learn->listening = true;
+    ir_learn->rx_active_ticks = 0;
+    ir_learn_rx_start(ir_learn);
+}
+
+void ir_learn_set_step_delay(IrLearnArgs* ir_learn, bool appending, uint32_t delay_ms) {
+    furi_assert(ir_learn);
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        {
+            model->appending = appending;
+            model->step_delay = MIN(delay_ms / IR_LEARN_DELAY_STEP_MS, UINT8_MAX);
+        },
+        false);
+}
+
+uint32_t ir_learn_get_step_delay(IrLearnArgs* ir_learn) {
+    furi_assert(ir_learn);
+    uint32_t delay_ms = 0;
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        { delay_ms = model->step_delay * IR_LEARN_DELAY_STEP_MS; },
+        false);
+    return delay_ms;
+}
+
+void ir_learn_set_max_timings(IrLearnArgs* ir_learn, uint16_t max_timings) {
+    furi_assert(ir_learn);
+    ir_learn->max_timings = max_timings;
+}
+
+// Only from the GUI thread, which is also the only one that starts the receiver
+size_t ir_learn_release_cache(IrLearnArgs* ir_learn) {
+    furi_assert(ir_learn);
+    size_t released = 0;
+
+    // A capture on screen hasn't been saved yet, that one has to stay
+    bool captured = false;
+    with_view_model_timed(
+        &ir_learn->lock_stats,
+        ir_learn->view,
+        IrLearnModel * model,
+        { captured = model->state == IrLearnStateCaptured; },
+        false);
+
+    // The worker replaces the result from its own thread, leave it alone while it runs
+    furi_mutex_acquire(ir_learn->worker_mutex, FuriWaitForever);
+    if(!captured && !ir_learn->worker_running &&
+       ir_learn->result.signal.kind == IrSignalKindRaw) {
+        released = ir_learn->result.signal.raw.timings_size * sizeof(uint32_t);
+        free(ir_learn->result.signal.raw.timings);
+        memset(&ir_learn->result, 0, sizeof(ir_learn->result));
+    }
+    furi_mutex_release(ir_learn->worker_mutex);
+    return released;
+}
+
+void ir_learn_set_idle_timeout(IrLearnArgs* ir_learn, uint32_t timeout_ms) {
+    furi_assert(ir_learn);
+    ir_learn->idle_timeout_ms = timeout_ms;
 }
 
 IrLearnArgs* ir_learn_alloc() {
@@ -236,24 +630,38 @@ IrLearnArgs* ir_learn_alloc() {
     ir_learn->signal_learned_callback = NULL;
     ir_learn->back_callback = NULL;
     ir_learn->context = NULL;
-    ir_learn->should_stop_worker = false;
-
-    ir_learn->result.has_signal = false;
-    ir_learn->result.is_decoded = false;
-    ir_learn->result.raw_timings = NULL;
-    ir_learn->result.raw_timings_size = 0;
-    ir_learn->result.frequency = 38000;
-    ir_learn->result.duty_cycle = 0.33f;
+    ir_learn->match_callback = NULL;
+    ir_learn->match_context = NULL;
+    ir_learn->import_callback = NULL;
+    ir_learn->import_context = NULL;
+    ir_learn->feedback = NULL;
+    ir_learn->trigger_callback = NULL;
+    ir_learn->trigger_context = NULL;
+    ir_learn->listening = false;
+    ir_learn->triggered = false;
+    ir_learn->trigger_fingerprint = IR_FINGERPRINT_NONE;
+    ir_learn->lock_stats = (LockStats){.name = "ir_learn"};
+
+    ir_learn->worker_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    ir_learn->worker_running = false;
+    ir_learn->idle_timer =
+        furi_timer_alloc(ir_learn_idle_timer_callback, FuriTimerTypeOnce, ir_learn);
+    ir_learn->idle_timeout_ms = IR_LEARN_IDLE_TIMEOUT_MS;
+    ir_learn->rx_start_tick = 0;
+    ir_learn->rx_active_ticks = 0;
+    ir_learn->max_timings = UINT16_MAX;
+
+    memset(&ir_learn->result, 0, sizeof(ir_learn->result));
 
     // Start in receiving state
-    with_view_model(
+    with_view_model_timed(
+        &ir_learn->lock_stats,
         ir_learn->view,
         IrLearnModel * model,
         {
-            model->receiving = true;
-            model->signal_received = false;
-            model->is_decoded = false;
-            memset(model->message, 0, sizeof(model->message));
+            model->state = IrLearnStateReceiving;
+            memset(&model->capture, 0, sizeof(model->capture));
+            model->reject = IrLearnRejectNone;
         },
         true);
 
@@ -265,16 +673,17 @@ IrLearnArgs* ir_learn_alloc() {
 void ir_learn_free(IrLearnArgs* ir_learn) {
     furi_assert(ir_learn);
     ir_learn->alive = false;
+    lock_stats_log(&ir_learn->lock_stats);
 
+    // Stopping a worker that isn't running crashes, ir_learn_rx_stop knows whether it is
+    ir_learn_stop_receiving(ir_learn);
+    furi_timer_free(ir_learn->idle_timer);
     infrared_worker_rx_set_received_signal_callback(ir_learn->infrared_worker, NULL, NULL);
-
-    // Trying to stop this causes the app to crash but we probably should stop it hmm
-    // infrared_worker_rx_stop(ir_learn->infrared_worker);
-
     infrared_worker_free(ir_learn->infrared_worker);
+    furi_mutex_free(ir_learn->worker_mutex);
 
-    if(ir_learn->result.raw_timings) {
-        free(ir_learn->result.raw_timings);
+    if(ir_learn->result.signal.kind == IrSignalKindRaw) {
+        free(ir_learn->result.signal.raw.timings);
     }
 
     view_free(ir_learn->view);
@@ -297,6 +706,38 @@ void ir_learn_set_callbacks(
     ir_learn->context = context;
 }
 
+void ir_learn_set_match_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnMatchCallback match_callback,
+    void* context) {
+    furi_assert(ir_learn);
+    ir_learn->match_callback = match_callback;
+    ir_learn->match_context = context;
+}
+
+void ir_learn_set_trigger_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnTriggerCallback trigger_callback,
+    void* context) {
+    furi_assert(ir_learn);
+    ir_learn->trigger_callback = trigger_callback;
+    ir_learn->trigger_context = context;
+}
+
+void ir_learn_set_feedback(IrLearnArgs* ir_learn, PtFeedback* feedback) {
+    furi_assert(ir_learn);
+    ir_learn->feedback = feedback;
+}
+
+void ir_learn_set_import_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnImportCallback import_callback,
+    void* context) {
+    furi_assert(ir_learn);
+    ir_learn->import_callback = import_callback;
+    ir_learn->import_context = context;
+}
+
 IrLearnResult ir_learn_get_result(IrLearnArgs* ir_learn) {
     furi_assert(ir_learn);
     return ir_learn->result;
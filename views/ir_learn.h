@@ -3,21 +3,38 @@
 #include <gui/view.h>
 #include <infrared.h>
 #include <infrared_worker.h>
+#include "../helpers/ir_signal.h"
+#include "../helpers/pt_feedback.h"
+
+// The receiver powers down after this long without a capture, 0 keeps it on
+#define IR_LEARN_IDLE_TIMEOUT_MS 30000
+// Up and Down change the wait before an appended macro step by this much, up to 25.5 s
+#define IR_LEARN_DELAY_STEP_MS 100
 
 typedef struct IrLearnArgs IrLearnArgs;
 typedef void (*IrLearnSignalLearnedCallback)(void* context);
 typedef void (*IrLearnBackCallback)(void* context);
+typedef void (*IrLearnImportCallback)(void* context);
+// Runs on the IR worker thread. picked is true when the signal was only chosen as the
+// trigger, false when it matched the trigger chosen before.
+typedef void (*IrLearnTriggerCallback)(void* context, uint32_t fingerprint, bool picked);
+// Returns true and where it is stored if a saved signal has this fingerprint
+typedef bool (*IrLearnMatchCallback)(
+    void* context,
+    uint32_t fingerprint,
+    uint8_t* slot,
+    uint8_t* step);
 
+// Raw timings in the signal belong to the view and stay valid until the next capture
 typedef struct {
-    bool has_signal;
-    bool is_decoded;
-    InfraredMessage decoded_message;
-    uint32_t* raw_timings;
-    size_t raw_timings_size;
-    uint32_t frequency;
-    float duty_cycle;
+    IrSignalStorage signal;
+    bool is_known;
+    uint8_t known_slot;
+    uint8_t known_step;
 } IrLearnResult;
 
+PT_SIZE_BUDGET(IrLearnResult, 28);
+
 IrLearnArgs* ir_learn_alloc();
 void ir_learn_free(IrLearnArgs* ir_learn);
 View* ir_learn_get_view(IrLearnArgs* ir_learn);
@@ -26,5 +43,31 @@ void ir_learn_set_callbacks(
     IrLearnSignalLearnedCallback signal_learned_callback,
     IrLearnBackCallback back_callback,
     void* context);
+void ir_learn_set_match_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnMatchCallback match_callback,
+    void* context);
+void ir_learn_set_import_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnImportCallback import_callback,
+    void* context);
+void ir_learn_set_trigger_callback(
+    IrLearnArgs* ir_learn,
+    IrLearnTriggerCallback trigger_callback,
+    void* context);
+void ir_learn_set_feedback(IrLearnArgs* ir_learn, PtFeedback* feedback);
 IrLearnResult ir_learn_get_result(IrLearnArgs* ir_learn);
+void ir_learn_set_idle_timeout(IrLearnArgs* ir_learn, uint32_t timeout_ms);
+// With appending set, the capture screen lets the wait before the new step be changed,
+// starting from delay_ms. Read the chosen wait back once the signal is learned.
+void ir_learn_set_step_delay(IrLearnArgs* ir_learn, bool appending, uint32_t delay_ms);
+uint32_t ir_learn_get_step_delay(IrLearnArgs* ir_learn);
+// Raw captures longer than this are refused with a message instead of being stored
+void ir_learn_set_max_timings(IrLearnArgs* ir_learn, uint16_t max_timings);
+// Frees the last capture's timings once nothing needs them, returns how many bytes
+size_t ir_learn_release_cache(IrLearnArgs* ir_learn);
 void ir_learn_start_receiving(IrLearnArgs* ir_learn);
+void ir_learn_stop_receiving(IrLearnArgs* ir_learn);
+// Watches for one signal instead of learning, IR_FINGERPRINT_NONE picks the next one
+// received as the trigger first
+void ir_learn_start_listening(IrLearnArgs* ir_learn, uint32_t trigger_fingerprint);
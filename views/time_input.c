@@ -4,6 +4,11 @@
 #include <gui/elements.h>
 #include <infrared.h>
 #include "../pause_timer.h"
+#include "../helpers/lock_stats.h"
+#include "../helpers/input_replay.h"
+#include "../helpers/pt_profile.h"
+#include "../helpers/stack_stats.h"
+#include "../helpers/size_budget.h"
 
 #define MAX_TIME_S 9999
 
@@ -22,9 +27,29 @@ typedef enum {
     PT_INPUT_CLEAR = 10,
     PT_INPUT_DEL = 11,
     PT_INPUT_START = 12,
-    PT_INPUT_LEARN = 13
+    PT_INPUT_LEARN = 13,
+    PT_INPUT_SLOT = 14,
+    PT_INPUT_ARM = 15
 } PTInputOption;
 
+typedef enum {
+    TimeInputActionNone,
+    TimeInputActionStart,
+    TimeInputActionLearn,
+    TimeInputActionSlot,
+    TimeInputActionOutput,
+    TimeInputActionArm,
+} TimeInputActionType;
+
+typedef struct {
+    TimeInputActionType type;
+    uint16_t timer_val;
+    uint8_t slot;
+    bool long_press;
+    bool wall_clock;
+    bool dual_output;
+} TimeInputAction;
+
 struct PTTimeInput {
     View* view;
     PauseTimerApp* pause_timer_app;
@@ -32,20 +57,31 @@ struct PTTimeInput {
     void* start_context;
     TimeInputLearnCallback learn_callback;
     void* learn_context;
+    TimeInputSlotCallback slot_callback;
+    void* slot_context;
+    uint8_t slot_count;
+    TimeInputOutputCallback output_callback;
+    void* output_context;
+    TimeInputArmCallback arm_callback;
+    void* arm_context;
+    LockStats lock_stats;
 };
 
+// Locked on every key press and draw, so it only keeps state that outlives one of them
 typedef struct {
+    uint16_t timer_val;
     uint8_t last_x;
     uint8_t last_y;
     uint8_t x;
     uint8_t y;
-    uint8_t last_key_code;
-    uint16_t modifier_code;
+    uint8_t slot;
     bool ok_pressed;
-    char key_string[10];
-    uint16_t timer_val;
+    bool wall_clock;
+    bool dual_output;
 } TimeInputModel;
 
+PT_SIZE_BUDGET(TimeInputModel, 10);
+
 typedef struct {
     uint8_t width;
     char* key;
@@ -88,14 +124,14 @@ const TimeInputKey time_input_keyset[ROW_COUNT][COLUMN_COUNT] = {
         {.width = 1, .height = 1, .key = "DEL", .value = PT_INPUT_DEL},
     },
     {
-        {.width = 3, .height = 1, .key = "START", .value = PT_INPUT_START},
-        {.width = 0, .height = 1, .key = "START", .value = PT_INPUT_START},
+        {.width = 2, .height = 1, .key = "START", .value = PT_INPUT_START},
         {.width = 0, .height = 1, .key = "START", .value = PT_INPUT_START},
+        {.width = 1, .height = 1, .key = "ARM", .value = PT_INPUT_ARM},
     },
     {
-        {.width = 3, .height = 1, .key = "LEARN", .value = PT_INPUT_LEARN},
-        {.width = 0, .height = 1, .key = "LEARN", .value = PT_INPUT_LEARN},
+        {.width = 2, .height = 1, .key = "LEARN", .value = PT_INPUT_LEARN},
         {.width = 0, .height = 1, .key = "LEARN", .value = PT_INPUT_LEARN},
+        {.width = 1, .height = 1, .key = "S", .value = PT_INPUT_SLOT},
     },
 };
 
@@ -128,15 +164,26 @@ static void time_input_draw_key(
             keyHeight);
     }
 
-    strncpy(model->key_string, key.key, sizeof(model->key_string) - 1);
-    model->key_string[sizeof(model->key_string) - 1] = '\0';
+    const char* label = key.key;
+    char slot_label[8];
+    if(key.value == PT_INPUT_SLOT) {
+        // The slot key shows which signal slot START and LEARN use, + for both outputs
+        snprintf(
+            slot_label,
+            sizeof(slot_label),
+            "%s%d%s",
+            key.key,
+            model->slot + 1,
+            model->dual_output ? "+" : "");
+        label = slot_label;
+    }
     canvas_draw_str_aligned(
         canvas,
         MARGIN_LEFT + x * (KEY_WIDTH + KEY_PADDING) + keyWidth / 2 + 1,
         MARGIN_TOP + y * (KEY_HEIGHT + KEY_PADDING) + keyHeight / 2 + 1,
         AlignCenter,
         AlignCenter,
-        model->key_string);
+        label);
 }
 
 static FuriString* get_timer_string(uint16_t timer_val) {
@@ -166,6 +213,8 @@ static void make_input(TimeInputModel* model, PTInputOption input) {
         // START button handled separately
     } else if(input == PT_INPUT_LEARN) {
         // LEARN button handled separately
+    } else if(input == PT_INPUT_ARM) {
+        // ARM button handled separately
     } else {
         temp_val *= 10;
         temp_val += input;
@@ -183,10 +232,13 @@ static void make_input(TimeInputModel* model, PTInputOption input) {
 
 static void time_input_draw_callback(Canvas* canvas, void* context) {
     furi_assert(context);
+    uint32_t profile_start = pt_profile_begin();
     TimeInputModel* model = context;
+    input_replay_draw();
 
     canvas_set_font(canvas, FontPrimary);
-    elements_multiline_text_aligned(canvas, 0, 1, AlignLeft, AlignTop, "Pause Timer");
+    elements_multiline_text_aligned(
+        canvas, 0, 1, AlignLeft, AlignTop, model->wall_clock ? "Fire At" : "Pause Timer");
 
     canvas_set_font(canvas, FontBigNumbers);
     FuriString* timer_str = get_timer_string(model->timer_val);
@@ -208,6 +260,10 @@ static void time_input_draw_callback(Canvas* canvas, void* context) {
             x += key.width;
         }
     }
+
+    pt_profile_end(PtProfileTimeInputDraw, profile_start);
+    pt_profile_draw_hud(canvas, PtProfileTimeInputDraw);
+    pt_stack_sample(PtStackDraw);
 }
 
 static PTInputOption time_input_get_selected_key(TimeInputModel* model) {
@@ -227,8 +283,13 @@ static void time_input_get_select_key(TimeInputModel* model, Point delta) {
     } while(delta.x != 0 && time_input_keyset[model->y][model->x].width == 0);
 }
 
-static void time_input_process(PTTimeInput* time_input, InputEvent* event) {
-    with_view_model(
+// Runs with the model locked, so it only updates state and reports what the caller
+// should do once the lock has been released
+static TimeInputAction time_input_process(PTTimeInput* time_input, InputEvent* event) {
+    TimeInputAction action = {.type = TimeInputActionNone};
+
+    with_view_model_timed(
+        &time_input->lock_stats,
         time_input->view,
         TimeInputModel * model,
         {
@@ -236,19 +297,46 @@ static void time_input_process(PTTimeInput* time_input, InputEvent* event) {
                 if(event->type == InputTypePress) {
                     model->ok_pressed = true;
                 } else if(event->type == InputTypeLong || event->type == InputTypeShort) {
-                    model->last_key_code = time_input_get_selected_key(model);
-
-                    if(model->last_key_code == PT_INPUT_START) {
-                        if(time_input->start_callback) {
-                            time_input->start_callback(
-                                time_input->start_context, model->timer_val);
+                    PTInputOption key_code = time_input_get_selected_key(model);
+
+                    if(key_code == PT_INPUT_START) {
+                        // A time of day has to be a real one before it can be started
+                        if(!model->wall_clock ||
+                           (model->timer_val / 100 <= 23 && model->timer_val % 100 <= 59)) {
+                            action.type = TimeInputActionStart;
+                            action.timer_val = model->timer_val;
+                            action.long_press = event->type == InputTypeLong;
+                            action.wall_clock = model->wall_clock;
+                        }
+                    } else if(
+                        key_code == PT_INPUT_CLEAR &&
+                        event->type == InputTypeLong) {
+                        // Holding OK on CLR switches between a duration and a time of day
+                        model->wall_clock = !model->wall_clock;
+                        make_input(model, PT_INPUT_CLEAR);
+                    } else if(key_code == PT_INPUT_ARM) {
+                        // A remote press can only start a duration, not a time of day
+                        if(!model->wall_clock) {
+                            action.type = TimeInputActionArm;
+                            action.timer_val = model->timer_val;
+                            action.long_press = event->type == InputTypeLong;
                         }
-                    } else if(model->last_key_code == PT_INPUT_LEARN) {
-                        if(time_input->learn_callback) {
-                            time_input->learn_callback(time_input->learn_context);
+                    } else if(key_code == PT_INPUT_LEARN) {
+                        action.type = TimeInputActionLearn;
+                        action.long_press = event->type == InputTypeLong;
+                    } else if(key_code == PT_INPUT_SLOT && event->type == InputTypeLong) {
+                        // Holding OK on the slot key toggles sending on both outputs
+                        model->dual_output = !model->dual_output;
+                        action.type = TimeInputActionOutput;
+                        action.dual_output = model->dual_output;
+                    } else if(key_code == PT_INPUT_SLOT) {
+                        if(time_input->slot_count) {
+                            model->slot = (model->slot + 1) % time_input->slot_count;
                         }
+                        action.type = TimeInputActionSlot;
+                        action.slot = model->slot;
                     } else {
-                        make_input(model, model->last_key_code);
+                        make_input(model, key_code);
                     }
                 } else if(event->type == InputTypeRelease) {
                     model->ok_pressed = false;
@@ -263,11 +351,6 @@ static void time_input_process(PTTimeInput* time_input, InputEvent* event) {
                        model->x == 3) {
                         model->x = model->last_x;
                         model->y = model->last_y;
-                    } else if(
-                        model->last_x == 2 && model->last_y == 4 && model->y == 3 &&
-                        model->x == 3) {
-                        model->x = model->last_x;
-                        model->y = model->last_y;
                     } else
                         time_input_get_select_key(model, (Point){.x = -1, .y = 0});
                     model->last_x = 0;
@@ -277,10 +360,6 @@ static void time_input_process(PTTimeInput* time_input, InputEvent* event) {
                         model->last_x = model->x;
                         model->last_y = model->y;
                         time_input_get_select_key(model, (Point){.x = 1, .y = -1});
-                    } else if(model->x == 2 && model->y == 4) {
-                        model->last_x = model->x;
-                        model->last_y = model->y;
-                        time_input_get_select_key(model, (Point){.x = 1, .y = -1});
                     } else {
                         time_input_get_select_key(model, (Point){.x = 1, .y = 0});
                     }
@@ -288,20 +367,62 @@ static void time_input_process(PTTimeInput* time_input, InputEvent* event) {
             }
         },
         true);
+
+    return action;
+}
+
+static void time_input_run_action(PTTimeInput* time_input, TimeInputAction action) {
+    if(action.type == TimeInputActionStart) {
+        if(time_input->start_callback) {
+            // Holding OK on START runs the timer in interval mode
+            time_input->start_callback(
+                time_input->start_context,
+                action.timer_val,
+                action.long_press,
+                action.wall_clock);
+        }
+    } else if(action.type == TimeInputActionLearn) {
+        if(time_input->learn_callback) {
+            // Holding OK on LEARN chains another step onto the macro
+            time_input->learn_callback(time_input->learn_context, action.long_press);
+        }
+    } else if(action.type == TimeInputActionSlot) {
+        if(time_input->slot_callback) {
+            time_input->slot_callback(time_input->slot_context, action.slot);
+        }
+    } else if(action.type == TimeInputActionOutput) {
+        if(time_input->output_callback) {
+            time_input->output_callback(time_input->output_context, action.dual_output);
+        }
+    } else if(action.type == TimeInputActionArm) {
+        if(time_input->arm_callback) {
+            // Holding OK on ARM picks a new trigger button before listening
+            time_input->arm_callback(
+                time_input->arm_context, action.timer_val, action.long_press);
+        }
+    }
 }
 
 static bool time_input_input_callback(InputEvent* event, void* context) {
     furi_assert(context);
     PTTimeInput* time_input = context;
     bool consumed = false;
+    uint32_t replay_start = input_replay_event_begin();
 
-    if(event->type == InputTypeShort && event->key == InputKeyBack) {
+    if(pt_profile_input(event)) {
+        consumed = true;
+    } else if(event->type == InputTypeShort && event->key == InputKeyBack) {
         // Used to release keys
     } else {
-        time_input_process(time_input, event);
+        uint32_t profile_start = pt_profile_begin();
+        TimeInputAction action = time_input_process(time_input, event);
+        pt_profile_end(PtProfileTimeInputProcess, profile_start);
+        time_input_run_action(time_input, action);
         consumed = true;
     }
 
+    pt_stack_sample(PtStackApp);
+    input_replay_event_end(replay_start);
     return consumed;
 }
 
@@ -313,6 +434,14 @@ PTTimeInput* time_input_alloc(PauseTimerApp* pt_app) {
     time_input->start_context = NULL;
     time_input->learn_callback = NULL;
     time_input->learn_context = NULL;
+    time_input->slot_callback = NULL;
+    time_input->slot_context = NULL;
+    time_input->slot_count = 0;
+    time_input->output_callback = NULL;
+    time_input->output_context = NULL;
+    time_input->arm_callback = NULL;
+    time_input->arm_context = NULL;
+    time_input->lock_stats = (LockStats){.name = "time_input"};
 
     view_set_context(time_input->view, time_input);
     view_allocate_model(time_input->view, ViewModelTypeLocking, sizeof(TimeInputModel));
@@ -328,11 +457,11 @@ PTTimeInput* time_input_alloc(PauseTimerApp* pt_app) {
             model->x = 0;
             model->last_x = 0;
             model->last_y = 0;
-            model->last_key_code = 0;
-            model->modifier_code = 0;
             model->ok_pressed = false;
             model->timer_val = 0;
-            memset(model->key_string, 0, sizeof(model->key_string));
+            model->wall_clock = false;
+            model->dual_output = false;
+            model->slot = 0;
         },
         true);
 
@@ -341,6 +470,7 @@ PTTimeInput* time_input_alloc(PauseTimerApp* pt_app) {
 
 void time_input_free(PTTimeInput* time_input) {
     furi_assert(time_input);
+    lock_stats_log(&time_input->lock_stats);
     view_free(time_input->view);
     free(time_input);
 }
@@ -367,3 +497,32 @@ void time_input_set_learn_callback(
     time_input->learn_callback = callback;
     time_input->learn_context = context;
 }
+
+void time_input_set_slot_callback(
+    PTTimeInput* time_input,
+    TimeInputSlotCallback callback,
+    void* context,
+    uint8_t slot_count) {
+    furi_assert(time_input);
+    time_input->slot_callback = callback;
+    time_input->slot_context = context;
+    time_input->slot_count = slot_count;
+}
+
+void time_input_set_output_callback(
+    PTTimeInput* time_input,
+    TimeInputOutputCallback callback,
+    void* context) {
+    furi_assert(time_input);
+    time_input->output_callback = callback;
+    time_input->output_context = context;
+}
+
+void time_input_set_arm_callback(
+    PTTimeInput* time_input,
+    TimeInputArmCallback callback,
+    void* context) {
+    furi_assert(time_input);
+    time_input->arm_callback = callback;
+    time_input->arm_context = context;
+}
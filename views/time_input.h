@@ -5,8 +5,17 @@
 typedef struct PauseTimerApp PauseTimerApp;
 typedef struct PTTimeInput PTTimeInput;
 
-typedef void (*TimeInputStartCallback)(void* context, uint16_t timer_val);
-typedef void (*TimeInputLearnCallback)(void* context);
+// In wall clock mode timer_val holds a time of day as HHMM instead of a MMSS duration
+typedef void (*TimeInputStartCallback)(
+    void* context,
+    uint16_t timer_val,
+    bool repeat,
+    bool wall_clock);
+typedef void (*TimeInputLearnCallback)(void* context, bool append);
+typedef void (*TimeInputSlotCallback)(void* context, uint8_t slot);
+typedef void (*TimeInputOutputCallback)(void* context, bool dual_output);
+// timer_val is always a MMSS duration, pick_trigger asks for a new trigger signal first
+typedef void (*TimeInputArmCallback)(void* context, uint16_t timer_val, bool pick_trigger);
 
 PTTimeInput* time_input_alloc(PauseTimerApp* pt_app);
 
@@ -22,3 +31,16 @@ void time_input_set_learn_callback(
     PTTimeInput* time_input,
     TimeInputLearnCallback callback,
     void* context);
+void time_input_set_slot_callback(
+    PTTimeInput* time_input,
+    TimeInputSlotCallback callback,
+    void* context,
+    uint8_t slot_count);
+void time_input_set_output_callback(
+    PTTimeInput* time_input,
+    TimeInputOutputCallback callback,
+    void* context);
+void time_input_set_arm_callback(
+    PTTimeInput* time_input,
+    TimeInputArmCallback callback,
+    void* context);